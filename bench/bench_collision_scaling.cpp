@@ -0,0 +1,48 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include "bench_utils.h"
+#include "cell_index.h"
+#include "collision.h"
+#include "grid.h"
+#include "sedimentation.h"
+#include "superparticle_store.h"
+
+// Cost of one collision step of a box against its population, for the mean
+// field BoxCollisions (O(n^2)) and the super droplet method (O(n)). The
+// droplets removed show that both act on the same particles.
+
+int main(int argc, char** argv) {
+    size_t max_n = argc > 1 ? std::atol(argv[1]) : 8192;
+    Grid grid(100., 100.);
+    FallSpeedLU sedi;
+    auto hall = mkHCS(sedi);
+    auto sdm = mkSDM(sedi, 42);
+    std::cout << std::setw(10) << "n" << std::setw(14) << "hall [ms]"
+              << std::setw(14) << "sdm [ms]" << std::setw(14) << "speedup"
+              << std::setw(16) << "hall dN" << std::setw(16) << "sdm dN"
+              << "\n";
+    for (size_t n = 16; n <= max_n; n *= 4) {
+        SuperparticleStore sps = bench_superparticles(grid, n);
+        CellIndex cells(grid);
+        cells.update(sps);
+        double dN_hall = 0, dN_sdm = 0;
+        double t_hall = time_min([&] {
+            dN_hall = 0;
+            for (const auto& t : hall->collide(sps, cells, 0.1)) {
+                dN_hall += t.dN;
+            }
+        });
+        double t_sdm = time_min([&] {
+            dN_sdm = 0;
+            for (const auto& t : sdm->collide(sps, cells, 0.1)) {
+                dN_sdm += t.dN;
+            }
+        });
+        std::cout << std::setw(10) << n << std::setprecision(4)
+                  << std::setw(14) << t_hall * 1.e3 << std::setw(14)
+                  << t_sdm * 1.e3 << std::setw(14) << t_hall / t_sdm
+                  << std::setw(16) << dN_hall << std::setw(16) << dN_sdm
+                  << "\n";
+    }
+}
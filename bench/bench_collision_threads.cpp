@@ -0,0 +1,61 @@
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "bench_utils.h"
+#include "cell_index.h"
+#include "collision.h"
+#include "grid.h"
+#include "sedimentation.h"
+#include "superparticle_store.h"
+
+// Strong scaling of the hall collisions over the boxes of a column from 1 to
+// 64 threads. The population of the layers grows exponentially towards the
+// cloud top, so a few boxes hold most of the work. The dN checksum has to be
+// the same for every thread count.
+
+int main(int argc, char** argv) {
+    size_t top = argc > 1 ? std::atol(argv[1]) : 2000;
+    unsigned int max_threads = argc > 2 ? std::atoi(argv[2]) : 64;
+    Grid grid(3000., 25.);
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<> qcdis(1.e-6, 1.e-4);
+    SuperparticleStore sps;
+    for (unsigned int l = 0; l < grid.n_lay; ++l) {
+        size_t n = top * std::exp(-0.1 * (grid.n_lay - 1. - l));
+        for (size_t i = 0; i < n; ++i) {
+            sps.push_back({qcdis(gen), grid.getlay(l), 1.e-8, 10000000});
+        }
+    }
+    CellIndex cells(grid);
+    cells.update(sps);
+    FallSpeedLU sedi;
+    std::cout << "superparticles: " << sps.size() << ", hardware threads: "
+              << std::thread::hardware_concurrency() << "\n";
+    std::cout << std::setw(10) << "threads" << std::setw(14) << "step [ms]"
+              << std::setw(14) << "speedup" << std::setw(14) << "efficiency"
+              << std::setw(24) << "dN checksum" << "\n";
+    double serial = 0;
+    for (unsigned int threads = 1; threads <= max_threads; threads *= 2) {
+        auto hall = mkHCS(sedi, threads);
+        std::vector<SpMassTendencies> tendencies;
+        double dN = 0;
+        double t = time_min([&] {
+            hall->collide(sps, cells, 0.1, tendencies);
+            dN = 0;
+            for (const auto& c : tendencies) {
+                dN += c.dN;
+            }
+        });
+        if (threads == 1) {
+            serial = t;
+        }
+        std::cout << std::setw(10) << threads << std::setprecision(4)
+                  << std::setw(14) << t * 1.e3 << std::setw(14) << serial / t
+                  << std::setw(14) << serial / t / threads
+                  << std::setprecision(17) << std::setw(24) << dN << "\n";
+    }
+}
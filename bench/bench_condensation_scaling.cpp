@@ -0,0 +1,53 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <thread>
+#include "bench_utils.h"
+#include "condensation.h"
+#include "grid.h"
+#include "saturation_fluctuations.h"
+#include "sedimentation.h"
+#include "state.h"
+#include "superparticle_store.h"
+
+// Strong scaling of the condensation phase from 1 to 64 threads. Every thread
+// count starts from the same state and particles, the qv checksum only
+// depends on the thread count.
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::atol(argv[1]) : 1000000;
+    unsigned int max_threads = argc > 2 ? std::atoi(argv[2]) : 64;
+    Grid grid(3000., 5.);
+
+    State initial = bench_state(grid);
+    SuperparticleStore sps = bench_superparticles(grid, n);
+
+    FallSpeedLU sedi;
+    NoFluctuationSolver fluctuations;
+    std::cout << "superparticles: " << n << ", hardware threads: "
+              << std::thread::hardware_concurrency() << "\n";
+    std::cout << std::setw(10) << "threads" << std::setw(14) << "step [ms]"
+              << std::setw(14) << "speedup" << std::setw(14) << "efficiency"
+              << std::setw(24) << "qv checksum" << "\n";
+    double serial = 0;
+    for (unsigned int threads = 1; threads <= max_threads; threads *= 2) {
+        State state(initial);
+        SuperparticleStore particles(sps);
+        Condensation condensation(sedi, threads);
+        double t = time_min([&] {
+            state.freeze();
+            condensation.condense(state, particles, fluctuations, 0.01);
+        });
+        if (threads == 1) {
+            serial = t;
+        }
+        double qv = std::accumulate(
+            state.layers.begin(), state.layers.end(), 0.,
+            [](double sum, const Layer& l) { return sum + l.qv; });
+        std::cout << std::setw(10) << threads << std::setprecision(4)
+                  << std::setw(14) << t * 1.e3 << std::setw(14) << serial / t
+                  << std::setw(14) << serial / t / threads
+                  << std::setprecision(17) << std::setw(24) << qv << "\n";
+    }
+}
@@ -0,0 +1,63 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "bench_utils.h"
+#include "cell_index.h"
+#include "condensation.h"
+#include "grid.h"
+#include "saturation_fluctuations.h"
+#include "sedimentation.h"
+#include "state.h"
+#include "superparticle_store.h"
+
+// Compares the phased particle update (check pass, fluctuation pass,
+// condensation pass) with the fused kernel that does all of it in one sweep.
+// Both use the markov fluctuation solver, the TauRelax refresh is the same
+// for both and not timed.
+
+template <typename G>
+static double time_kernel(bool fused, unsigned int threads,
+                          const State& initial, const SuperparticleStore& sps,
+                          G& gen) {
+    const Grid& grid = initial.grid;
+    State state(initial);
+    SuperparticleStore particles(sps);
+    FallSpeedLU sedi;
+    MarkovFluctuationSolver<G> fluctuations(gen, 50.e-4, 100., grid);
+    CellIndex cells(grid);
+    cells.update(particles);
+    fluctuations.refresh(particles, cells);
+    Condensation condensation(sedi, threads, fused);
+    return time_min([&] {
+        state.freeze();
+        if (!fused) {
+            for (const auto& sp : particles) {
+                check_sp(sp);
+            }
+        }
+        condensation.condense(state, particles, fluctuations, 0.01);
+    });
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::atol(argv[1]) : 1000000;
+    unsigned int threads = argc > 2 ? std::atoi(argv[2]) : 1;
+    Grid grid(3000., 5.);
+    State initial = bench_state(grid);
+    SuperparticleStore sps = bench_superparticles(grid, n);
+    std::mt19937_64 gen(42);
+
+    double phased = time_kernel(false, threads, initial, sps, gen);
+    double fused = time_kernel(true, threads, initial, sps, gen);
+
+    std::cout << "superparticles: " << n << ", threads: " << threads << "\n";
+    std::cout << std::setw(10) << "kernel" << std::setw(14) << "step [ms]"
+              << std::setw(14) << "ns/particle" << "\n";
+    std::cout << std::setprecision(4) << std::setw(10) << "phased"
+              << std::setw(14) << phased * 1.e3 << std::setw(14)
+              << phased * 1.e9 / n << "\n";
+    std::cout << std::setw(10) << "fused" << std::setw(14) << fused * 1.e3
+              << std::setw(14) << fused * 1.e9 / n << "\n";
+    std::cout << "speedup: " << phased / fused << std::endl;
+}
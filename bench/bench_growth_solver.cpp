@@ -0,0 +1,52 @@
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "bench_utils.h"
+#include "thermodynamic.h"
+
+// Accuracy against cost of the diffusional growth integrators: a freshly
+// activated droplet grows for 10 s at S = 1 %, with and without radiative
+// cooling, with the step size of the model (dt) ranging from 0.01 s to 10 s.
+// The reference is the euler scheme with dt = 1 us.
+
+typedef double (*Solver)(double, double, double, double, double, double);
+
+static double integrate(Solver solver, double r, double E, double dt,
+                        double t_end) {
+    const double es = saturation_pressure(283.15);
+    int n = std::lround(t_end / dt);
+    for (int i = 0; i < n; ++i) {
+        r = solver(r, es, 283.15, 0.01, E, dt);
+    }
+    return r;
+}
+
+int main() {
+    const double r0 = 2.e-8;
+    const double t_end = 10.;
+    std::cout << std::setw(8) << "E" << std::setw(10) << "dt"
+              << std::setw(16) << "euler error" << std::setw(16)
+              << "implicit error" << std::setw(14) << "euler ns"
+              << std::setw(14) << "implicit ns" << "\n";
+    for (double E : {0., -50.}) {
+        double ref = integrate(condensation_solver, r0, E, 1.e-6, t_end);
+        for (double dt : {0.01, 0.1, 1., 10.}) {
+            double euler = 0, implicit = 0;
+            double t_euler = time_min([&] {
+                euler = integrate(condensation_solver, r0, E, dt, t_end);
+            });
+            double t_implicit = time_min([&] {
+                implicit =
+                    integrate(implicit_condensation_solver, r0, E, dt, t_end);
+            });
+            int n = std::lround(t_end / dt);
+            std::cout << std::setprecision(3) << std::setw(8) << E
+                      << std::setw(10) << dt << std::setw(16)
+                      << std::abs(euler - ref) / ref << std::setw(16)
+                      << std::abs(implicit - ref) / ref << std::setw(14)
+                      << t_euler * 1.e9 / n << std::setw(14)
+                      << t_implicit * 1.e9 / n << "\n";
+        }
+    }
+}
@@ -0,0 +1,332 @@
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include "analize_sp.h"
+#include "bench_utils.h"
+#include "cell_index.h"
+#include "collision.h"
+#include "efficiencies.h"
+#include "grid.h"
+#include "indexed_iterator.h"
+#include "kernal_cache.h"
+#include "ns_table.h"
+#include "sedimentation.h"
+#include "state.h"
+#include "superparticle_store.h"
+#include "tau_relax.h"
+#include "thermodynamic.h"
+#include "twomey.h"
+
+// Microbenchmarks of the physics kernels, each at a few problem sizes. The
+// results are written as json to the file given as first argument, or to
+// stdout, so runs of different releases can be compared entry by entry.
+// The bench target runs this into bench_kernels.json of the build directory.
+
+/// keeps the compiler from dropping the benchmarked computations
+static volatile double sink;
+
+static std::vector<BenchResult> results;
+
+static void record(const std::string& name, size_t size, size_t items,
+                   double seconds) {
+    results.push_back({name, size, items, seconds});
+    std::cerr << name << " " << size << ": " << seconds * 1.e3 << " ms\n";
+}
+
+static void bench_box_collisions() {
+    FallSpeedLU sedi;
+    BoxCollisions<HallCollisionKernal<Efficiencies>> collider(
+        sedi, HallCollisionKernal<Efficiencies>({}));
+    Grid grid(100., 100.);
+    for (size_t n : {2, 8, 32, 128, 512}) {
+        SuperparticleStore sps = bench_superparticles(grid, n);
+        std::vector<size_t> box(n);
+        std::iota(box.begin(), box.end(), 0);
+        std::vector<SpMassTendencies> tendencies(n);
+        int reps = std::max<int>(1, 100000 / (n * n));
+        double t = time_min([&] {
+            for (int i = 0; i < reps; ++i) {
+                collider.collide(
+                    indexed_iterator(sps.begin(), box.begin()),
+                    indexed_iterator(sps.begin(), box.end()),
+                    indexed_iterator(tendencies.begin(), box.begin()), 1.);
+            }
+            sink = tendencies[0].dN;
+        });
+        record("box_collisions", n, n * reps, t);
+    }
+}
+
+static void bench_condensation() {
+    const size_t n = 100000;
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<> qcdis(1.e-6, 1.e-4);
+    std::vector<double> qc(n);
+    for (auto& q : qc) {
+        q = qcdis(gen);
+    }
+    for (auto scheme : {GrowthScheme::euler, GrowthScheme::implicit}) {
+        double t = time_min([&] {
+            double sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                sum += condensation(qc[i], 1.e7, 1.e-8, 0.01, 283.15, 0., 0.1,
+                                    scheme)
+                           .dqc;
+            }
+            sink = sum;
+        });
+        record(scheme == GrowthScheme::euler ? "condensation_euler"
+                                             : "condensation_implicit",
+               n, n, t);
+    }
+}
+
+static void bench_fall_speed() {
+    const size_t n = 1000000;
+    FallSpeedLU lookup;
+    const Sedimentation& sedi = lookup;
+    std::vector<double> r(n);
+    for (size_t i = 0; i < n; ++i) {
+        r[i] = 1.e-6 + 3.e-3 * i / n;
+    }
+    double t = time_min([&] {
+        double sum = 0;
+        for (double x : r) {
+            sum += sedi.fall_speed(x);
+        }
+        sink = sum;
+    });
+    record("fall_speed_lookup", n, n, t);
+    std::vector<double> v(n);
+    t = time_min([&] {
+        sedi.fall_speed(r.data(), v.data(), n);
+        sink = v[n / 2];
+    });
+    record("fall_speed_batch", n, n, t);
+}
+
+static void bench_collision_efficiency() {
+    const size_t n = 1000000;
+    Efficiencies efficiencies;
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<> Rdis(1., 300.);
+    std::uniform_real_distribution<> rRdis(0., 1.);
+    std::vector<double> R(n), rR(n);
+    for (size_t i = 0; i < n; ++i) {
+        R[i] = Rdis(gen);
+        rR[i] = rRdis(gen);
+    }
+    double t = time_min([&] {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += efficiencies.collision_efficiency(R[i], rR[i]);
+        }
+        sink = sum;
+    });
+    record("collision_efficiency", n, n, t);
+    UniformEfficiencies uniform;
+    t = time_min([&] {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += uniform.collision_efficiency(R[i], rR[i]);
+        }
+        sink = sum;
+    });
+    record("collision_efficiency_uniform", n, n, t);
+}
+
+static void bench_hall_kernal() {
+    const size_t n = 1000000;
+    HallCollisionKernal<Efficiencies> kernal({});
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<> lnr(std::log(2.e-6), std::log(50.e-6));
+    std::vector<double> r(n), R(n);
+    for (size_t i = 0; i < n; ++i) {
+        double a = std::exp(lnr(gen)), b = std::exp(lnr(gen));
+        r[i] = std::min(a, b);
+        R[i] = std::max(a, b);
+    }
+    double t = time_min([&] {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += kernal(r[i], R[i], 1.);
+        }
+        sink = sum;
+    });
+    record("hall_kernal", n, n, t);
+    HallCollisionKernal<UniformEfficiencies> uniform({});
+    t = time_min([&] {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += uniform(r[i], R[i], 1.);
+        }
+        sink = sum;
+    });
+    record("hall_kernal_uniform", n, n, t);
+    // rows of larger partners, as in the box collisions
+    std::vector<double> fs(n), k(n);
+    FallSpeedLU sedi;
+    for (size_t i = 0; i < n; ++i) {
+        fs[i] = sedi.fall_speed(R[i]);
+    }
+    const size_t row = 1000;
+    t = time_min([&] {
+        double sum = 0;
+        for (size_t i = 0; i < n; i += row) {
+            kernal_row(kernal, 2.e-6, 0., &R[i], &fs[i], &k[i], row);
+            sum += k[i];
+        }
+        sink = sum;
+    });
+    record(std::string("hall_kernal_row_") + kernal_row_isa(), n, n, t);
+    for (double tolerance : {1.e-2, 1.e-3}) {
+        CachedCollisionKernal<HallCollisionKernal<Efficiencies>> cached(
+            kernal, tolerance);
+        t = time_min([&] {
+            double sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                sum += cached(r[i], R[i], 1.);
+            }
+            sink = sum;
+        });
+        record(tolerance > 5.e-3 ? "cached_hall_kernal_1e-2"
+                                 : "cached_hall_kernal_1e-3",
+               n, n, t);
+        std::cerr << "  hits: " << cached.hits()
+                  << ", misses: " << cached.misses() << "\n";
+    }
+}
+
+template <typename K>
+static void bench_advection(const std::string& name, K kernel) {
+    const int reps = 1000;
+    for (size_t n_lay : {120, 600}) {
+        std::vector<double> q(n_lay), w(n_lay + 1, 1.);
+        for (size_t i = 0; i < n_lay; ++i) {
+            q[i] = 1.e-2 * std::exp(-double(i) / n_lay);
+        }
+        double t = time_min([&] {
+            for (int i = 0; i < reps; ++i) {
+                kernel(q.begin(), q.end(), w.begin(), 25., 1.);
+            }
+            sink = q[n_lay / 2];
+        });
+        record(name, n_lay, n_lay * reps, t);
+    }
+}
+
+typedef std::vector<double>::iterator DIt;
+
+static void bench_advection_kernels() {
+    bench_advection("advect_first_order", advect_first_order<DIt, DIt>);
+    bench_advection("first_order_upwind", first_order_upwind<DIt, DIt>);
+    bench_advection("second_order_upwind", second_order_upwind<DIt, DIt>);
+    bench_advection("second_first_order_upwind",
+                    second_first_order_upwind<DIt, DIt>);
+    bench_advection("third_order_upwind", third_order_upwind<DIt, DIt>);
+    bench_advection("sixth_order_wickerskamarock",
+                    sixth_order_wickerskamarock<DIt, DIt>);
+}
+
+static void bench_tau_relax() {
+    Grid grid(3000., 5.);
+    for (size_t n : {10000, 100000, 1000000}) {
+        SuperparticleStore sps = bench_superparticles(grid, n);
+        CellIndex cells(grid);
+        cells.update(sps);
+        TauRelax tau(grid);
+        double t = time_min([&] {
+            tau.refresh(sps, cells);
+            sink = tau(1500.);
+        });
+        record("tau_relax_refresh", n, n, t);
+    }
+}
+
+static void bench_twomey() {
+    // the cost does not depend on the values of the n(s) table, a made up
+    // one keeps the benchmark independent of the data files
+    NsData ns{{0., 1.e7, 5.e7, 1.e8, 2.e8}, {0., 1.e-5, 1.e-4, 1.e-3, 1.e-2}};
+    Grid grid(3000., 25.);
+    const State initial = bench_state(grid);
+    std::mt19937_64 gen(42);
+    for (size_t n : {0, 10000, 100000}) {
+        // the particles present only cost their count, with a
+        // multiplicity of 1 they don't suppress the activation
+        SuperparticleStore initial_sps = bench_superparticles(grid, n);
+        for (size_t i = 0; i < n; ++i) {
+            initial_sps.N[i] = 1;
+        }
+        Twomey<SlotInsertIterator, std::mt19937_64> twomey(gen, 200,
+                                                           grid.n_lay, ns);
+        State state(initial);
+        SuperparticleStore sps;
+        CellIndex cells(grid);
+        double t = time_min_with_setup(
+            [&] {
+                state.layers = initial.layers;
+                sps = initial_sps;
+                cells.rebuild(sps);
+            },
+            [&] {
+                twomey.generateParticles(slot_inserter(sps), state, 0.1, sps,
+                                         cells);
+            });
+        sink = sps.size();
+        record("twomey_generate_particles", n, grid.n_lay, t);
+    }
+}
+
+template <typename P>
+static void bench_profile(const std::string& name, P profile) {
+    Grid grid(3000., 5.);
+    for (size_t n : {10000, 1000000}) {
+        SuperparticleStore sps = bench_superparticles(grid, n);
+        CellIndex cells(grid);
+        cells.update(sps);
+        double t = time_min([&] { sink = profile(sps, cells)[grid.n_lay / 2]; });
+        record(name, n, n, t);
+    }
+}
+
+typedef SuperparticleStore Sps;
+
+static void bench_profiles() {
+    bench_profile("count_falling", count_falling<Sps, CellIndex>);
+    bench_profile("count_falling_ccn", count_falling_ccn<Sps, CellIndex>);
+    bench_profile("count_nucleated", count_nucleated<Sps, CellIndex>);
+    bench_profile("count_nucleated_ccn", count_nucleated_ccn<Sps, CellIndex>);
+    bench_profile("qc_profile", calculate_qc_profile<Sps, CellIndex>);
+    bench_profile("maximal_radius_profile",
+                  calculate_maximal_radius_profile<Sps, CellIndex>);
+    bench_profile("minimal_radius_profile",
+                  calculate_minimal_radius_profile<Sps, CellIndex>);
+    bench_profile("effective_radius_profile",
+                  calculate_effective_radius_profile<Sps, CellIndex>);
+    bench_profile("mean_radius_profile",
+                  calculate_mean_radius_profile<Sps, CellIndex>);
+    bench_profile("stddev_radius_profile",
+                  calculate_stddev_radius_profile<Sps, CellIndex>);
+}
+
+int main(int argc, char** argv) {
+    bench_box_collisions();
+    bench_condensation();
+    bench_fall_speed();
+    bench_collision_efficiency();
+    bench_hall_kernal();
+    bench_advection_kernels();
+    bench_tau_relax();
+    bench_twomey();
+    bench_profiles();
+    if (argc > 1) {
+        std::ofstream os(argv[1]);
+        write_json(os, results);
+    } else {
+        write_json(std::cout, results);
+    }
+}
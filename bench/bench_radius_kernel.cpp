@@ -0,0 +1,40 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include "bench_utils.h"
+#include "grid.h"
+#include "radius_kernel.h"
+#include "superparticle_store.h"
+#include "thermodynamic.h"
+
+// Refreshing the radii of all superparticles: per particle update with
+// radius() from thermodynamic.cpp (std::pow) against the batch kernel of
+// SuperparticleStore::update_radii (fast_cbrt).
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::atol(argv[1]) : 1000000;
+    Grid grid(3000., 5.);
+    SuperparticleStore sps = bench_superparticles(grid, n);
+
+    double t_pow = time_min([&] {
+        for (size_t i = 0; i < sps.size(); ++i) {
+            sps.update(i);
+        }
+    });
+    AlignedColumn<double> exact(sps.radius);
+    double t_batch = time_min([&] { sps.update_radii(0, sps.size()); });
+
+    double max_error = 0;
+    for (size_t i = 0; i < sps.size(); ++i) {
+        max_error = std::max(max_error,
+                             std::abs(sps.radius[i] - exact[i]) / exact[i]);
+    }
+    std::cout << "superparticles: " << n << "\n"
+              << std::setprecision(4) << "std::pow: " << t_pow * 1.e9 / n
+              << " ns/particle\n"
+              << "batch:    " << t_batch * 1.e9 / n << " ns/particle\n"
+              << "speedup:  " << t_pow / t_batch << "\n"
+              << "max relative error: " << max_error << std::endl;
+}
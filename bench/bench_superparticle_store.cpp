@@ -0,0 +1,131 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_utils.h"
+#include "grid.h"
+#include "superparticle.h"
+#include "superparticle_store.h"
+
+// Compares the per particle sweeps of one model step for the old array of
+// structures layout (std::vector<Superparticle>) and the SuperparticleStore.
+// Bytes moved are estimated from the fields each sweep touches: in the AoS
+// layout every touched record costs a full cache line, in the SoA layout only
+// the touched columns are streamed.
+
+struct Phase {
+    std::string name;
+    size_t aos_bytes;
+    size_t soa_bytes;
+    double aos_time;
+    double soa_time;
+};
+
+static void print(const std::vector<Phase>& phases, size_t n) {
+    std::cout << std::setw(16) << "phase" << std::setw(14) << "AoS [MB]"
+              << std::setw(14) << "SoA [MB]" << std::setw(14) << "AoS [ms]"
+              << std::setw(14) << "SoA [ms]" << std::setw(14) << "AoS [GB/s]"
+              << std::setw(14) << "SoA [GB/s]" << "\n";
+    Phase total{"step", 0, 0, 0, 0};
+    for (auto p : phases) {
+        total.aos_bytes += p.aos_bytes;
+        total.soa_bytes += p.soa_bytes;
+        total.aos_time += p.aos_time;
+        total.soa_time += p.soa_time;
+    }
+    auto all = phases;
+    all.push_back(total);
+    for (const auto& p : all) {
+        std::cout << std::setw(16) << p.name << std::setprecision(4)
+                  << std::setw(14) << p.aos_bytes / 1.e6 << std::setw(14)
+                  << p.soa_bytes / 1.e6 << std::setw(14) << p.aos_time * 1.e3
+                  << std::setw(14) << p.soa_time * 1.e3 << std::setw(14)
+                  << p.aos_bytes / p.aos_time / 1.e9 << std::setw(14)
+                  << p.soa_bytes / p.soa_time / 1.e9 << "\n";
+    }
+    std::cout << "bytes per particle and step: AoS "
+              << double(total.aos_bytes) / n << ", SoA "
+              << double(total.soa_bytes) / n << std::endl;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::atol(argv[1]) : 1000000;
+    Grid grid(3000., 1.);
+
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<> zdis(0.5, grid.height - 0.5);
+    std::uniform_real_distribution<> qcdis(1.e-6, 1.e-4);
+    std::vector<Superparticle> aos;
+    SuperparticleStore soa;
+    aos.reserve(n);
+    soa.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        Superparticle sp{qcdis(gen), zdis(gen), 1.e-8, 1000000};
+        aos.push_back(sp);
+        soa.push_back(sp);
+    }
+
+    std::vector<double> prf(grid.n_lay, 0.);
+    std::vector<Phase> phases;
+    size_t line = 64;
+    size_t aos_record = std::max(sizeof(Superparticle), line);
+
+    // TauRelax::refresh: z, radius, N
+    phases.push_back(
+        {"tau_relax", n * aos_record,
+         n * (sizeof(double) + sizeof(double) + sizeof(int)),
+         time_min([&] {
+             for (const auto& s : aos) {
+                 prf[grid.getlayindex(s.z)] += s.radius() * s.N;
+             }
+         }),
+         time_min([&] {
+             for (size_t i = 0; i < soa.size(); ++i) {
+                 prf[grid.getlayindex(soa.z[i])] += soa.radius[i] * soa.N[i];
+             }
+         })});
+
+    // calculate_qc_profile: is_nucleated, z, qc
+    phases.push_back(
+        {"qc_profile", n * aos_record,
+         n * (sizeof(bool) + sizeof(double) + sizeof(double)),
+         time_min([&] {
+             for (const auto& s : aos) {
+                 if (s.is_nucleated) {
+                     prf[grid.getlayindex(s.z)] += s.qc;
+                 }
+             }
+         }),
+         time_min([&] {
+             for (size_t i = 0; i < soa.size(); ++i) {
+                 if (soa.is_nucleated[i]) {
+                     prf[grid.getlayindex(soa.z[i])] += soa.qc[i];
+                 }
+             }
+         })});
+
+    // collision tendencies: qc, N, r_dry, z read, radius and flag written
+    phases.push_back(
+        {"radius_update", 2 * n * aos_record,
+         n * (3 * sizeof(double) + sizeof(int) + 2 * sizeof(double) +
+              sizeof(bool)),
+         time_min([&] {
+             for (auto& s : aos) {
+                 s.qc *= 1.0000001;
+                 s.update();
+             }
+         }),
+         time_min([&] {
+             for (size_t i = 0; i < soa.size(); ++i) {
+                 soa.qc[i] *= 1.0000001;
+                 soa.update(i);
+             }
+         })});
+
+    std::cout << "superparticles: " << n
+              << ", sizeof(Superparticle): " << sizeof(Superparticle)
+              << ", checksum: " << prf[grid.n_lay / 2] << "\n";
+    print(phases, n);
+}
@@ -0,0 +1,92 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "analize_sp.h"
+#include "bench_utils.h"
+#include "cell_index.h"
+#include "grid.h"
+#include "superparticle.h"
+#include "superparticle_store.h"
+
+// Steady state particle turnover of a rain heavy run: every step a fraction
+// of the live particles rains out and as many new particles nucleate. The
+// current behaviour removes the dead particles every step, which shifts the
+// columns and forces a rebuild of the cell index. Tombstones keep the dead
+// slots, hand them to the new particles and only compact above a threshold.
+
+struct Run {
+    double seconds;
+    size_t slots;
+};
+
+static Run run(const Grid& grid, const SuperparticleStore& initial,
+               double turnover, double threshold, bool tombstones,
+               int steps) {
+    SuperparticleStore sps(initial);
+    CellIndex cells(grid);
+    cells.update(sps);
+    std::mt19937_64 gen(1);
+    std::uniform_real_distribution<> zdis(1., grid.height - 10.);
+    std::vector<double> prf(grid.n_lay, 0.);
+    size_t n_new = turnover * initial.size();
+
+    double t = time_min(
+        [&] {
+            for (int step = 0; step < steps; ++step) {
+                std::uniform_int_distribution<size_t> idis(0, sps.size() - 1);
+                for (size_t k = 0; k < n_new;) {
+                    size_t i = idis(gen);
+                    if (sps.is_nucleated[i]) {
+                        sps.is_nucleated[i] = false;
+                        ++k;
+                    }
+                }
+                if (tombstones) {
+                    sps.collect_dead();
+                    if (sps.n_dead() > threshold * sps.size()) {
+                        removeUnnucleated(sps);
+                    }
+                } else {
+                    removeUnnucleated(sps);
+                }
+                auto it = slot_inserter(sps);
+                for (size_t k = 0; k < n_new; ++k) {
+                    *it++ = Superparticle{1.e-5, zdis(gen), 1.e-8, 10000000};
+                }
+                cells.update(sps);
+                for (size_t l = 0; l < cells.size(); ++l) {
+                    for (auto i : cells[l]) {
+                        prf[l] += sps.radius[i] * sps.N[i];
+                    }
+                }
+            }
+        },
+        3);
+    return {t / steps, sps.size()};
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::atol(argv[1]) : 1000000;
+    double turnover = argc > 2 ? std::atof(argv[2]) : 0.05;
+    int steps = 20;
+    Grid grid(3000., 5.);
+    SuperparticleStore sps = bench_superparticles(grid, n);
+
+    std::cout << "superparticles: " << n << ", turnover per step: " << turnover
+              << "\n";
+    std::cout << std::setw(24) << "liveness" << std::setw(14) << "step [ms]"
+              << std::setw(18) << "particles/s" << std::setw(12) << "slots"
+              << "\n";
+    auto print = [&](const std::string& name, Run r) {
+        std::cout << std::setw(24) << name << std::setprecision(4)
+                  << std::setw(14) << r.seconds * 1.e3 << std::setw(18)
+                  << n / r.seconds << std::setw(12) << r.slots << "\n";
+    };
+    print("remove every step", run(grid, sps, turnover, 0., false, steps));
+    for (double threshold : {0.1, 0.25, 0.5}) {
+        print("tombstones, compact > " + std::to_string(threshold).substr(0, 4),
+              run(grid, sps, turnover, threshold, true, steps));
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "grid.h"
+#include "state.h"
+#include "superparticle_store.h"
+#include "thermodynamic.h"
+
+/// returns the fastest of n runs of f in seconds
+template <typename F>
+double time_min(F f, int n = 5) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < n; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+/// as time_min, with setup() called untimed before every run of f
+template <typename S, typename F>
+double time_min_with_setup(S setup, F f, int n = 5) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < n; ++i) {
+        setup();
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+/// one timing of a benchmark, items is the number of elements (particles,
+/// layers, calls) processed in seconds
+struct BenchResult {
+    std::string name;
+    std::size_t size;
+    std::size_t items;
+    double seconds;
+};
+
+/// writes the results as a json array, stable for diffs between releases
+inline void write_json(std::ostream& os,
+                       const std::vector<BenchResult>& results) {
+    os << "[";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        os << (i ? "," : "") << "\n  {\"name\": \"" << r.name
+           << "\", \"size\": " << r.size << ", \"items\": " << r.items
+           << ", \"seconds\": " << r.seconds << ", \"ns_per_item\": "
+           << r.seconds * 1.e9 / std::max<std::size_t>(1, r.items) << "}";
+    }
+    os << "\n]\n";
+}
+
+/// slightly supersaturated column at constant pressure, updraft of 1 m/s
+inline State bench_state(const Grid& grid) {
+    State state{0, {}, {}, grid, 500., 1.};
+    for (unsigned int i = 0; i < grid.n_lay; ++i) {
+        double T = 285. - 0.006 * grid.getlay(i);
+        double p = 95000.;
+        state.layers.push_back({T, p, saturation_vapor(T, p) * 1.01, 0.});
+    }
+    for (unsigned int i = 0; i < grid.n_lvl; ++i) {
+        state.levels.push_back({1., 95000.});
+    }
+    return state;
+}
+
+/// n nucleated superparticles, uniformly distributed over the column
+inline SuperparticleStore bench_superparticles(const Grid& grid, size_t n) {
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<> zdis(1., grid.height - 10.);
+    std::uniform_real_distribution<> qcdis(1.e-6, 1.e-4);
+    SuperparticleStore sps;
+    sps.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        sps.push_back({qcdis(gen), zdis(gen), 1.e-8, 10000000});
+    }
+    return sps;
+}
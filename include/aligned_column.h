@@ -0,0 +1,94 @@
+#pragma once
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/** \brief contiguous, cache line aligned storage for one superparticle field
+ *
+ * A minimal growable array for trivially copyable types. Unlike std::vector it
+ * guarantees the alignment of the first element and is not specialized for
+ * bool, so references to single elements can be handed out for every type.
+ */
+template <typename T, std::size_t Alignment = 64>
+class AlignedColumn {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "AlignedColumn only stores trivially copyable types");
+
+   public:
+    typedef T value_type;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    AlignedColumn() = default;
+    AlignedColumn(const AlignedColumn& other) {
+        reserve(other.n);
+        std::memcpy(ptr, other.ptr, other.n * sizeof(T));
+        n = other.n;
+    }
+    AlignedColumn(AlignedColumn&& other) noexcept { swap(other); }
+    AlignedColumn& operator=(AlignedColumn other) {
+        swap(other);
+        return *this;
+    }
+    ~AlignedColumn() { std::free(ptr); }
+
+    void swap(AlignedColumn& other) noexcept {
+        std::swap(ptr, other.ptr);
+        std::swap(n, other.n);
+        std::swap(cap, other.cap);
+    }
+
+    std::size_t size() const { return n; }
+    std::size_t capacity() const { return cap; }
+    bool empty() const { return n == 0; }
+
+    void reserve(std::size_t new_cap) {
+        if (new_cap <= cap) {
+            return;
+        }
+        void* mem = nullptr;
+        if (posix_memalign(&mem, Alignment, new_cap * sizeof(T)) != 0) {
+            throw std::bad_alloc();
+        }
+        if (ptr) {
+            std::memcpy(mem, ptr, n * sizeof(T));
+            std::free(ptr);
+        }
+        ptr = static_cast<T*>(mem);
+        cap = new_cap;
+    }
+
+    void resize(std::size_t new_size, T value = T()) {
+        reserve(new_size);
+        std::fill(ptr + std::min(n, new_size), ptr + new_size, value);
+        n = new_size;
+    }
+
+    void push_back(T value) {
+        if (n == cap) {
+            reserve(std::max<std::size_t>(2 * cap, 16));
+        }
+        ptr[n++] = value;
+    }
+
+    void clear() { n = 0; }
+
+    T& operator[](std::size_t i) { return ptr[i]; }
+    const T& operator[](std::size_t i) const { return ptr[i]; }
+
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+
+    iterator begin() { return ptr; }
+    iterator end() { return ptr + n; }
+    const_iterator begin() const { return ptr; }
+    const_iterator end() const { return ptr + n; }
+
+   private:
+    T* ptr = nullptr;
+    std::size_t n = 0;
+    std::size_t cap = 0;
+};
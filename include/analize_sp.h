@@ -3,102 +3,134 @@
 #include <cmath>
 #include <cstdlib>
 #include <vector>
+#include "cell_index.h"
 #include "grid.h"
 #include "superparticle.h"
+#include "superparticle_store.h"
 #include "thermodynamic.h"
 
 inline void removeUnnucleated(std::vector<Superparticle>& superparticles) {
     auto fwd_it =
         std::remove_if(superparticles.begin(), superparticles.end(),
-                       [](Superparticle s) { return !s.is_nucleated; });
+                       [](const Superparticle& s) { return !s.is_nucleated; });
     superparticles.erase(fwd_it, superparticles.end());
 }
 
-template <typename T>
+inline void removeUnnucleated(SuperparticleStore& superparticles) {
+    superparticles.remove_unnucleated();
+}
+
+inline size_t n_layers(const Grid& grid) { return grid.n_lay; }
+
+/// calls f(layer, sp) for every superparticle, the layer is taken from z
+template <typename Sps, typename F>
+inline void for_each_in_layer(const Sps& superparticles, const Grid& grid,
+                              F f) {
+    for (const auto& sp : superparticles) {
+        f(grid.getlayindex(sp.z), sp);
+    }
+}
+
+/// calls f(layer, sp) for every superparticle listed in the cell index
+template <typename F>
+inline void for_each_in_layer(const SuperparticleStore& superparticles,
+                              const CellIndex& cells, F f) {
+    for (size_t l = 0; l < cells.size(); ++l) {
+        for (auto i : cells[l]) {
+            f(l, superparticles[i]);
+        }
+    }
+}
+
+template <typename T, typename Sps, typename Bins, typename F, typename G>
 inline std::vector<T> count_sp(
-    const std::vector<Superparticle>& superparticles, 
-    const Grid& grid,
-    bool (*f)(const Superparticle& s), 
-    T (*g)(const Superparticle& s))
+    const Sps& superparticles, 
+    const Bins& bins,
+    F f, 
+    G g)
 {
-    std::vector<T> res(grid.n_lay, 0);
-    for (const auto& sp : superparticles) {
+    std::vector<T> res(n_layers(bins), 0);
+    for_each_in_layer(superparticles, bins, [&](size_t index, const auto& sp) {
        if(f(sp)){
-           int index =  grid.getlayindex(sp.z);
            res[index] += g(sp);
        }
-    }
+    });
     return res;
 }
 
-inline std::vector<int> count_falling(const std::vector<Superparticle>& sps, const Grid& grid){
-    return count_sp<int>(sps, grid, [](const Superparticle& s){return s.is_nucleated && (s.v<0);},
-            [](const Superparticle& s){ return 1;});
+template <typename Sps, typename Bins>
+inline std::vector<int> count_falling(const Sps& sps, const Bins& bins){
+    return count_sp<int>(sps, bins, [](const auto& s){return s.is_nucleated && (s.v<0);},
+            [](const auto& s){ return 1;});
 }
 
-inline std::vector<int> count_falling_ccn(const std::vector<Superparticle>& sps, const Grid& grid){
-    return count_sp<int>(sps, grid, [](const Superparticle& s){return s.is_nucleated && (s.v<0);},
-            [](const Superparticle& s){ return s.N;});
+template <typename Sps, typename Bins>
+inline std::vector<int> count_falling_ccn(const Sps& sps, const Bins& bins){
+    return count_sp<int>(sps, bins, [](const auto& s){return s.is_nucleated && (s.v<0);},
+            [](const auto& s){ return s.N;});
 }
 
+template <typename Sps, typename Bins>
 inline std::vector<int> count_nucleated(
-    const std::vector<Superparticle>& sps, const Grid& grid) {
-    return count_sp<int>(sps, grid, [](const Superparticle& s){return s.is_nucleated;},
-            [](const Superparticle& s){return 1;});
+    const Sps& sps, const Bins& bins) {
+    return count_sp<int>(sps, bins, [](const auto& s){return s.is_nucleated;},
+            [](const auto& s){return 1;});
 }
 
+template <typename Sps, typename Bins>
 inline std::vector<int> count_nucleated_ccn(
-    const std::vector<Superparticle>& sps, const Grid& grid) {
-    return count_sp<int>(sps, grid, [](const Superparticle& s){return s.is_nucleated;},
-            [](const Superparticle& s){return s.N;});
+    const Sps& sps, const Bins& bins) {
+    return count_sp<int>(sps, bins, [](const auto& s){return s.is_nucleated;},
+            [](const auto& s){return s.N;});
 }
 
+template <typename Sps, typename Bins>
 inline std::vector<double> calculate_qc_profile(
-    const std::vector<Superparticle>& sps, const Grid& grid) {
-    return count_sp<double>(sps, grid, [](const Superparticle& s){return s.is_nucleated;},
-            [](const Superparticle& s){return s.qc;});
+    const Sps& sps, const Bins& bins) {
+    return count_sp<double>(sps, bins, [](const auto& s){return s.is_nucleated;},
+            [](const auto& s){return s.qc;});
 }
 
+template <typename Sps, typename Bins>
 inline std::vector<double> calculate_maximal_radius_profile(
-    const std::vector<Superparticle>& superparticles, const Grid& grid) {
-    std::vector<double> res(grid.n_lay, 0);
-    for (auto sp : superparticles) {
+    const Sps& superparticles, const Bins& bins) {
+    std::vector<double> res(n_layers(bins), 0);
+    for_each_in_layer(superparticles, bins, [&](size_t index, const auto& sp) {
         if (sp.is_nucleated) {
-            int index =  grid.getlayindex(sp.z);
             res[index] = std::max(sp.radius(), res[index]);
         }
-    }
+    });
     return res;
 }
 
 
+template <typename Sps, typename Bins>
 inline std::vector<double> calculate_minimal_radius_profile(
-    const std::vector<Superparticle>& superparticles, const Grid& grid) {
-    std::vector<double> res(grid.n_lay, 0);
+    const Sps& superparticles, const Bins& bins) {
+    std::vector<double> res(n_layers(bins), 0);
 
-    for (auto sp : superparticles) {
+    for_each_in_layer(superparticles, bins, [&](size_t index, const auto& sp) {
         if (sp.is_nucleated) {
-            int index =  grid.getlayindex(sp.z);
             res[index] = std::min(sp.radius(), res[index]);
         }
-    }
+    });
     return res;
 }
 
 
+template <typename Sps, typename Bins>
 inline std::vector<double> calculate_effective_radius_profile(
-    const std::vector<Superparticle>& superparticles, const Grid& grid) {
-    std::vector<double> r2(grid.n_lay, 0);
-    std::vector<double> r3(grid.n_lay, 0);
-    std::vector<double> res(grid.n_lay, 0);
+    const Sps& superparticles, const Bins& bins) {
+    std::vector<double> r2(n_layers(bins), 0);
+    std::vector<double> r3(n_layers(bins), 0);
+    std::vector<double> res(n_layers(bins), 0);
 
-    for (auto sp : superparticles) {
+    for_each_in_layer(superparticles, bins, [&](size_t index, const auto& sp) {
         if (sp.is_nucleated) {
-            int index =  grid.getlayindex(sp.z);
             r2[index] += std::pow(sp.radius(), 2);
             r3[index] += std::pow(sp.radius(), 3);
         }
-    }
+    });
     std::transform(r3.begin(), r3.end(), r2.begin(), res.begin(),
                    std::divides<void>());
 
@@ -107,18 +139,18 @@ inline std::vector<double> calculate_effective_radius_profile(
     return res;
 }
 
+template <typename Sps, typename Bins>
 inline std::vector<double> calculate_mean_radius_profile(
-    const std::vector<Superparticle>& superparticles, const Grid& grid) {
-    std::vector<double> count(grid.n_lay, 0);
-    std::vector<double> res(grid.n_lay, 0);
+    const Sps& superparticles, const Bins& bins) {
+    std::vector<double> count(n_layers(bins), 0);
+    std::vector<double> res(n_layers(bins), 0);
 
-    for (auto sp : superparticles) {
+    for_each_in_layer(superparticles, bins, [&](size_t index, const auto& sp) {
         if (sp.is_nucleated) {
-            int index =  grid.getlayindex(sp.z);
             count[index] += 1;
             res[index] += sp.radius();
         }
-    }
+    });
     std::transform(res.begin(), res.end(), count.begin(), res.begin(),
                    std::divides<void>());
 
@@ -127,21 +159,21 @@ inline std::vector<double> calculate_mean_radius_profile(
     return res;
 }
 
+template <typename Sps, typename Bins>
 inline std::vector<double> calculate_stddev_radius_profile(
-    const std::vector<Superparticle>& superparticles, const Grid& grid) {
-    std::vector<double> count(grid.n_lay, 0);
-    std::vector<double> r2(grid.n_lay, 0);
-    std::vector<double> mean(grid.n_lay, 0);
-    std::vector<double> res(grid.n_lay, 0);
+    const Sps& superparticles, const Bins& bins) {
+    std::vector<double> count(n_layers(bins), 0);
+    std::vector<double> r2(n_layers(bins), 0);
+    std::vector<double> mean(n_layers(bins), 0);
+    std::vector<double> res(n_layers(bins), 0);
 
-    for (auto sp : superparticles) {
+    for_each_in_layer(superparticles, bins, [&](size_t index, const auto& sp) {
         if (sp.is_nucleated) {
-            int index =  grid.getlayindex(sp.z);
             count[index] += 1;
             r2[index] += std::pow(sp.radius(), 2);
             mean[index] += sp.radius();
         }
-    }
+    });
     std::transform(mean.begin(), mean.end(), count.begin(), mean.begin(),
                    std::divides<void>());
 
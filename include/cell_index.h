@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "checkpoint.h"
+#include "grid.h"
+#include "superparticle_store.h"
+
+/** \brief per layer lists of superparticle indices
+ *
+ * Keeps the index of every nucleated superparticle in the list of the layer
+ * given by Grid::getlayindex. update() compares each particle with the layer
+ * it was filed under and only moves the ones that changed layer, so keeping
+ * the index current costs O(N) per step and the particles of one layer are
+ * available in O(1). Unnucleated particles are not listed.
+ */
+class CellIndex {
+   public:
+    CellIndex(const Grid& grid) : grid(grid), cells(grid.n_lay) {}
+
+    /// files new particles and moves particles that changed their layer
+    void update(const SuperparticleStore& sps);
+    /// drops all entries and files every particle again
+    void rebuild(const SuperparticleStore& sps);
+
+    size_t size() const { return cells.size(); }
+    const std::vector<size_t>& operator[](size_t layer) const {
+        return cells[layer];
+    }
+    /// layer of particle i, -1 if it is not listed
+    int cell_of(size_t i) const { return cell[i]; }
+
+    /// the lists are saved as they are, a rebuild could order them
+    /// differently
+    void save(CheckpointWriter& w) const {
+        w.section("CELL");
+        w.write(cells);
+        w.write(cell);
+        w.write(slot);
+        w.write(std::uint64_t(generation));
+    }
+
+    void load(CheckpointReader& r) {
+        r.section("CELL");
+        r.read(cells);
+        r.read(cell);
+        r.read(slot);
+        std::uint64_t g;
+        r.read(g);
+        generation = g;
+        if (cells.size() != grid.n_lay) {
+            throw std::runtime_error(
+                "the checkpoint does not match the configuration: cells");
+        }
+    }
+
+   private:
+    void insert(size_t i, int c);
+    void remove(size_t i);
+    int layer_of(const SuperparticleStore& sps, size_t i) const;
+
+    const Grid& grid;
+    std::vector<std::vector<size_t>> cells;
+    std::vector<int> cell;
+    std::vector<size_t> slot;
+    size_t generation = 0;
+};
+
+inline size_t n_layers(const CellIndex& cells) { return cells.size(); }
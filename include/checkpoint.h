@@ -0,0 +1,185 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "aligned_column.h"
+
+/** \brief binary checkpoint streams
+ *
+ * A checkpoint starts with the magic "CMCKPT" and checkpoint_version,
+ * followed by tagged sections written by the save() members of the model
+ * components. Values are stored in native byte order, so checkpoints are
+ * meant to be restarted on the machine (type) that wrote them. Bump
+ * checkpoint_version whenever the layout of a section changes.
+ */
+constexpr std::uint32_t checkpoint_version = 2;
+
+class CheckpointWriter {
+   public:
+    explicit CheckpointWriter(std::ostream& os) : os(os) {
+        raw("CMCKPT", 6);
+        write(checkpoint_version);
+    }
+
+    /// four character tag, checked by CheckpointReader::section
+    void section(const char* tag) { raw(tag, 4); }
+
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "only trivially copyable values are written raw");
+        raw(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void write(const std::vector<T>& v) {
+        write(std::uint64_t(v.size()));
+        raw(v.data(), v.size() * sizeof(T));
+    }
+
+    template <typename T>
+    void write(const std::vector<std::vector<T>>& v) {
+        write(std::uint64_t(v.size()));
+        for (const auto& el : v) {
+            write(el);
+        }
+    }
+
+    template <typename T, std::size_t A>
+    void write(const AlignedColumn<T, A>& c) {
+        write(std::uint64_t(c.size()));
+        raw(c.data(), c.size() * sizeof(T));
+    }
+
+    void write(const std::string& s) {
+        write(std::uint64_t(s.size()));
+        raw(s.data(), s.size());
+    }
+
+    /// state of a standard random number engine or distribution, in the
+    /// text representation of its stream operators
+    template <typename G>
+    void write_streamed(const G& gen) {
+        std::ostringstream ss;
+        ss << gen;
+        write(ss.str());
+    }
+
+   private:
+    void raw(const void* data, std::size_t n) {
+        os.write(static_cast<const char*>(data), n);
+        if (!os) {
+            throw std::runtime_error("writing the checkpoint failed");
+        }
+    }
+
+    std::ostream& os;
+};
+
+class CheckpointReader {
+   public:
+    explicit CheckpointReader(std::istream& is) : is(is) {
+        char magic[6];
+        raw(magic, 6);
+        if (std::memcmp(magic, "CMCKPT", 6) != 0) {
+            throw std::runtime_error("the stream is not a checkpoint");
+        }
+        std::uint32_t version;
+        read(version);
+        if (version != checkpoint_version) {
+            throw std::runtime_error("the checkpoint version " +
+                                     std::to_string(version) +
+                                     " is not supported, expected " +
+                                     std::to_string(checkpoint_version));
+        }
+    }
+
+    void section(const char* tag) {
+        char found[4];
+        raw(found, 4);
+        if (std::memcmp(found, tag, 4) != 0) {
+            throw std::runtime_error("the checkpoint section " +
+                                     std::string(found, 4) +
+                                     " was found instead of " +
+                                     std::string(tag, 4));
+        }
+    }
+
+    template <typename T>
+    void read(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "only trivially copyable values are read raw");
+        raw(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void read(std::vector<T>& v) {
+        v.resize(count());
+        raw(v.data(), v.size() * sizeof(T));
+    }
+
+    template <typename T>
+    void read(std::vector<std::vector<T>>& v) {
+        v.resize(count());
+        for (auto& el : v) {
+            read(el);
+        }
+    }
+
+    template <typename T, std::size_t A>
+    void read(AlignedColumn<T, A>& c) {
+        c.resize(count());
+        raw(c.data(), c.size() * sizeof(T));
+    }
+
+    void read(std::string& s) {
+        s.resize(count());
+        raw(&s[0], s.size());
+    }
+
+    template <typename G>
+    void read_streamed(G& gen) {
+        std::string s;
+        read(s);
+        std::istringstream ss(s);
+        ss >> gen;
+        if (!ss) {
+            throw std::runtime_error(
+                "the checkpoint holds no valid generator state");
+        }
+    }
+
+    /// the value written with CheckpointWriter::write, which has to be equal
+    /// to expected, e.g. a size fixed by the configuration
+    template <typename T>
+    void expect(const T& expected, const std::string& what) {
+        T found;
+        read(found);
+        if (found != expected) {
+            throw std::runtime_error("the checkpoint does not match the "
+                                     "configuration: " + what);
+        }
+    }
+
+   private:
+    std::uint64_t count() {
+        std::uint64_t n;
+        read(n);
+        return n;
+    }
+
+    void raw(void* data, std::size_t n) {
+        is.read(static_cast<char*>(data), n);
+        if (!is) {
+            throw std::runtime_error("the checkpoint is truncated");
+        }
+    }
+
+    std::istream& is;
+};
@@ -1,18 +1,29 @@
 #pragma once
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <vector>
+#include "aligned_column.h"
+#include "cell_index.h"
+#include "checkpoint.h"
 #include "constants.h"
+#include "diagnostics.h"
 #include "efficiencies.h"
-#include "efficiencies.h"
+#include "indexed_iterator.h"
 #include "interpolate.h"
+#include "kernal_cache.h"
 #include "member_iterator.h"
+#include "philox.h"
 #include "sedimentation.h"
 #include "superparticle.h"
+#include "superparticle_store.h"
 #include "thermodynamic.h"
+#include "thread_pool.h"
 
 template <typename E>
 class HallCollisionKernal {
@@ -21,17 +32,42 @@ class HallCollisionKernal {
         : efficiencies(efficiencies) {}
     double operator()(double r, double R, double dfs) const {
         if (R <= 0.) {
-            std::cout << "R in hall_collision_kernal is zero of smaller: " << R
-                      << std::endl;
+            report(Diagnostic::nonpositive_collision_radius, R);
         }
         return PI * (R + r) * (R + r) * std::abs(dfs) *
                efficiencies.collision_efficiency(R * 1.e6, r / R);
     }
 
+    const E& collision_efficiencies() const { return efficiencies; }
+
    private:
     E efficiencies;
 };
 
+/// out[j] = kernal(r, R[j], fs - fs_R[j]) for j < n
+template <typename K>
+void kernal_row(const K& kernal, double r, double fs, const double* R,
+                const double* fs_R, double* out, std::size_t n) {
+    for (std::size_t j = 0; j < n; ++j) {
+        out[j] = kernal(r, R[j], fs - fs_R[j]);
+    }
+}
+
+/** \brief kernal_row of the hall kernal with the tabulated Efficiencies
+ *
+ * Uses the branchless efficiency lookup, so the loop vectorizes with gathers
+ * from the table. On x86-64 with gcc or clang it is compiled for AVX-512,
+ * AVX2 and the baseline, and the widest one the cpu supports is selected at
+ * startup. The results differ from the scalar kernal by less than 1e-12
+ * times the geometric kernal, efficiency 1, see test_collision.
+ */
+void kernal_row(const HallCollisionKernal<Efficiencies>& kernal, double r,
+                double fs, const double* R, const double* fs_R, double* out,
+                std::size_t n);
+
+/// instruction set of the hall kernal_row: avx512, avx2 or default
+const char* kernal_row_isa();
+
 struct SpMassTendencies {
     double dqc;
     double dN;
@@ -40,23 +76,49 @@ struct SpMassTendencies {
 class Collisions {
    public:
     virtual ~Collisions() {}
-    virtual std::vector<SpMassTendencies> collide(
-        const std::vector<Superparticle>& sps, const Grid& grid, double dt) = 0;
-    virtual bool needs_sorted_superparticles() = 0;
+    /// writes the tendencies of all slots of sps into tendencies, which is
+    /// reused between steps. Left empty if there are no collisions at all
+    virtual void collide(const SuperparticleStore& sps, const CellIndex& cells,
+                         double dt,
+                         std::vector<SpMassTendencies>& tendencies) = 0;
+    /// the tendencies in a new vector, sized to sps
+    std::vector<SpMassTendencies> collide(const SuperparticleStore& sps,
+                                          const CellIndex& cells, double dt) {
+        std::vector<SpMassTendencies> tendencies;
+        collide(sps, cells, dt, tendencies);
+        tendencies.resize(sps.size());
+        return tendencies;
+    }
+    /// state of stochastic solvers for the checkpoint, see checkpoint.h
+    virtual void save(CheckpointWriter& w) const {}
+    virtual void load(CheckpointReader& r) {}
+    /// named counters for the profile report
+    virtual std::vector<std::pair<std::string, double>> counters() const {
+        return {};
+    }
+    /// named counts of the last collide(), sampled every step by the profile
+    virtual std::vector<std::pair<std::string, double>> step_counters()
+        const {
+        return {};
+    }
 };
 
-static inline bool sp_zcmp(const Superparticle& sp, double z) {
-    return sp.z < z;
-}
-
+/** \brief mean field collisions of the particles of one box
+ *
+ * The kernal is evaluated once per pair of particles and may only depend on
+ * the absolute fall speed difference.
+ */
 template <typename CollisionKernal>
 class BoxCollisions {
    public:
+    typedef CollisionKernal kernal_type;
+
     BoxCollisions(const Sedimentation& sedimentation,
                   CollisionKernal collision_kernal)
         : sedimentation(sedimentation), collision_kernal(collision_kernal) {}
+    /// only reads the members, boxes may collide concurrently
     template <typename SpIt, typename TIt>
-    void collide(SpIt first, SpIt last, TIt out, double dt) {
+    void collide(SpIt first, SpIt last, TIt out, double dt) const {
         size_t pc = std::distance(first, last);
         if (pc < 2) {
             return;
@@ -65,6 +127,30 @@ class BoxCollisions {
         collider.calculate();
     }
 
+    const CollisionKernal& kernal() const { return collision_kernal; }
+
+    /** \brief heuristic score of the collisions per droplet of the box in dt
+     *
+     * pi (2 r_max)^2 |v(r_max) - v(r_min)| dt times the droplets of the box,
+     * the collisions of the largest drop with efficiency 1. This is not a
+     * bound, the hall efficiencies reach 4. Small, nearly monodisperse boxes
+     * of fresh droplets score low, O(n).
+     */
+    template <typename SpIt>
+    double activity(SpIt first, SpIt last, double dt) const {
+        double r_min = std::numeric_limits<double>::max(), r_max = 0.;
+        double N = 0.;
+        for (auto it = first; it != last; ++it) {
+            double r = it->radius();
+            r_min = std::min(r_min, r);
+            r_max = std::max(r_max, r);
+            N += it->N;
+        }
+        double dv = std::abs(sedimentation.fall_speed(r_max) -
+                             sedimentation.fall_speed(r_min));
+        return 4. * PI * r_max * r_max * dv * N * dt;
+    }
+
    private:
     const Sedimentation& sedimentation;
     CollisionKernal collision_kernal;
@@ -79,67 +165,72 @@ class BoxCollisions {
             assert(pc >= 2);
             csps.reserve(pc);
             for (auto it = first; it != last; ++it) {
-                double r = it->radius();
-                csps.push_back({r, size_t(std::distance(first, it)), double(it->N),
-                                  params.sedimentation.fall_speed(r), it->qc});
+                csps.push_back({it->radius(), size_t(std::distance(first, it)),
+                                double(it->N)});
             }
             std::sort(csps.begin(), csps.end());
-        }
-
-        void calculate() {
-            size_t isp;
+            // one allocation for all columns, each starting on a cache line
+            size_t stride = (pc + 7) / 8 * 8;
+            columns.resize(6 * stride, 0.);
+            r = columns.data();
+            N = r + stride;
+            fs = N + stride;
+            k = fs + stride;
+            from_smaller = k + stride;
+            from_larger = from_smaller + stride;
             for (size_t i = 0; i < pc; ++i) {
-                isp = csps[i].i;
-                out[isp].dN = weights(i);
-                out[isp].dqc = 4. / 3. * PI * RHO_H2O * csps[i].N * mass(i);
-            }
-        }
-
-       private:
-        double weights(size_t i) {
-            auto r = csps[i].r;
-            double internal_collisions = -params.collision_kernal(r, r, 0) *
-                                         0.5 * csps[i].N * (csps[i].N - 1);
-            double external_collisions = 0;
-            for (auto j = i + 1; j < pc; ++j) {
-                auto R = csps[j].r;
-                external_collisions -=
-                    params.collision_kernal(r, R,
-                                            csps[i].fs - csps[j].fs) *
-                    csps[i].N * csps[j].N;
+                r[i] = csps[i].r;
+                N[i] = csps[i].N;
             }
-            return dt * (internal_collisions + external_collisions);
+            params.sedimentation.fall_speed(r, fs, pc);
         }
 
-        double mass(size_t i) {
-            auto ri = csps[i].r;
-            double from_smaller = 0;
-            for (size_t j = 0; j < i; ++j) {
-                auto rj = csps[j].r;
-                from_smaller += params.collision_kernal(
-                                    rj, ri, csps[i].fs - csps[j].fs) *
-                                csps[j].N * rj * rj * rj;
+        /// evaluates the kernal once per pair, a row of the larger partners
+        /// at a time, and accumulates the tendencies of both partners from
+        /// it, the particles are sorted by radius
+        void calculate() {
+            for (size_t i = 0; i < pc; ++i) {
+                size_t m = pc - i - 1;
+                const double* k_j = k + i + 1;
+                const double* N_j = N + i + 1;
+                double* smaller_j = from_smaller + i + 1;
+                kernal_row(params.collision_kernal, r[i], fs[i], r + i + 1,
+                           fs + i + 1, k + i + 1, m);
+                double gain = N[i] * r[i] * r[i] * r[i];
+                double loss = 0;
+                for (size_t j = 0; j < m; ++j) {
+                    smaller_j[j] += k_j[j] * gain;
+                    loss -= k_j[j] * N_j[j];
+                }
+                from_larger[i] = loss;
             }
-            double from_larger = 0;
-            for (size_t j = i + 1; j < pc; ++j) {
-                auto rj = csps[j].r;
-                from_larger -= params.collision_kernal(
-                                   ri, rj, csps[i].fs - csps[j].fs) *
-                               csps[j].N * ri * ri * ri;
+            for (size_t i = 0; i < pc; ++i) {
+                double internal = params.collision_kernal(r[i], r[i], 0) *
+                                  0.5 * N[i] * (N[i] - 1);
+                double mass =
+                    from_smaller[i] + from_larger[i] * r[i] * r[i] * r[i];
+                out[csps[i].i].dN = dt * (N[i] * from_larger[i] - internal);
+                out[csps[i].i].dqc =
+                    4. / 3. * PI * RHO_H2O * N[i] * dt * mass;
             }
-            return dt * (from_smaller + from_larger);
         }
 
+       private:
         struct CollideSp {
             double r;
             size_t i;
             double N;
-            double fs;
-            double qc;
             bool operator<(const CollideSp& other) const { return r < other.r; }
         };
 
         std::vector<CollideSp> csps;
+        AlignedColumn<double> columns;
+        double* r;
+        double* N;
+        double* fs;
+        double* k;             ///< kernal of the current row
+        double* from_smaller;  ///< N r^3 rate gained, per N
+        double* from_larger;   ///< N rate lost to larger ones
         TIt out;
         double dt;
         size_t pc;
@@ -150,51 +241,380 @@ class BoxCollisions {
     friend class Collider;
 };
 
+/** \brief collides the particles of every layer of the cell index
+ *
+ * With more than one thread the boxes are handed to the threads of a pool,
+ * its own or one shared with the condensation, the most populated first, as
+ * the work per box grows quadratically. Every box writes the tendencies of
+ * its own particles only, so the result is the same for any number of
+ * threads. Kernals that are not thread safe, see
+ * is_thread_safe_kernal, always collide on the calling thread.
+ *
+ * With skip_below > 0 boxes whose BoxCollisions::activity, a heuristic
+ * score, is below it are skipped. The step counters report the skipped and computed boxes of the
+ * last step.
+ *
+ * A box is one layer by default. With box_layers > 1 it joins that many
+ * layers, with box_particles > 0 it adds layers from the bottom up until it
+ * holds that many particles, the top layers that fall short join the box
+ * below. N is a concentration within the layer of a particle, so the
+ * particles of a box of m populated layers collide with dt / m, which keeps
+ * the collision rate per volume. Empty layers, as above the cloud top, do not
+ * count. Fewer, larger boxes amortize the setup of every box on fine grids.
+ */
 template <typename C>
 class BoxCollisionAdapter : public Collisions {
    public:
-    BoxCollisionAdapter(const C& boxcollider) : boxcollider(boxcollider) {}
-
-    std::vector<SpMassTendencies> collide(const std::vector<Superparticle>& sps,
-                                          const Grid& grid,
-                                          double dt) override {
-        std::vector<SpMassTendencies> tendencies(sps.size());
-        const auto& lvls = grid.getlvls();
-        if (lvls.empty()) {
-            return tendencies;
-        }
-        auto it1 = std::lower_bound(sps.begin(), sps.end(), lvls[0], sp_zcmp);
-        for (size_t i = 1; i < lvls.size(); ++i) {
-            auto it2 = std::lower_bound(it1, sps.end(), lvls[i], sp_zcmp);
-            auto tit1 = tendencies.begin() + std::distance(sps.begin(), it1);
-            boxcollider.collide(it1, it2, tit1, dt);
+    BoxCollisionAdapter(const C& boxcollider, unsigned int threads = 1,
+                        double skip_below = 0., unsigned int box_layers = 1,
+                        std::size_t box_particles = 0)
+        : boxcollider(boxcollider),
+          own_pool(std::make_unique<ThreadPool>(
+              is_thread_safe_kernal<typename C::kernal_type>::value ? threads
+                                                                    : 1)),
+          pool(*own_pool),
+          skip_below(skip_below),
+          box_layers(std::max(1u, box_layers)),
+          box_particles(box_particles) {}
+    /// collides on the threads of pool, which may be shared with other phases
+    BoxCollisionAdapter(const C& boxcollider, ThreadPool& pool,
+                        double skip_below = 0., unsigned int box_layers = 1,
+                        std::size_t box_particles = 0)
+        : boxcollider(boxcollider),
+          pool(pool),
+          skip_below(skip_below),
+          box_layers(std::max(1u, box_layers)),
+          box_particles(box_particles) {}
 
-            it1 = it2;
+    void collide(const SuperparticleStore& sps, const CellIndex& cells,
+                 double dt,
+                 std::vector<SpMassTendencies>& tendencies) override {
+        tendencies.assign(sps.size(), {0., 0.});
+        make_boxes(cells);
+        order.clear();
+        skipped = 0;
+        for (size_t b = 0; b < boxes.size(); ++b) {
+            if (boxes[b].particles->size() < 2) {
+                continue;
+            }
+            if (skip_below > 0. && is_quiescent(sps, boxes[b], dt)) {
+                ++skipped;
+                continue;
+            }
+            order.push_back(b);
         }
-        return tendencies;
+        computed = order.size();
+        if (threads() == 1) {
+            for (auto b : order) {
+                collide_box(sps, boxes[b], tendencies, dt);
+            }
+            return;
+        }
+        std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return boxes[a].particles->size() > boxes[b].particles->size();
+        });
+        pool.run(order.size(), [&](size_t k) {
+            collide_box(sps, boxes[order[k]], tendencies, dt);
+        });
+    }
+
+    unsigned int threads() const {
+        return is_thread_safe_kernal<typename C::kernal_type>::value
+                   ? pool.size()
+                   : 1;
+    }
+
+    std::vector<std::pair<std::string, double>> counters() const override {
+        return kernal_counters(boxcollider.kernal());
+    }
+
+    std::vector<std::pair<std::string, double>> step_counters()
+        const override {
+        return {{"collision_boxes_computed", double(computed)},
+                {"collision_boxes_skipped", double(skipped)}};
     }
-    bool needs_sorted_superparticles() override { return true; }
 
    private:
+    struct Box {
+        const std::vector<size_t>* particles;
+        double layers;
+    };
+
+    void make_boxes(const CellIndex& cells) {
+        boxes.clear();
+        if (box_layers == 1 && box_particles == 0) {
+            for (size_t l = 0; l < cells.size(); ++l) {
+                boxes.push_back({&cells[l], 1.});
+            }
+            return;
+        }
+        size_t n = 0;
+        for (size_t first = 0; first < cells.size();) {
+            size_t last = first, count = 0, populated = 0;
+            do {
+                populated += !cells[last].empty();
+                count += cells[last++].size();
+            } while (last < cells.size() &&
+                     (last - first < box_layers || count < box_particles));
+            if (n > 0 && count < box_particles) {
+                // the top layers join the box below
+                --n;
+                layers[n] += populated;
+            } else {
+                if (merged.size() == n) {
+                    merged.emplace_back();
+                    layers.emplace_back();
+                }
+                merged[n].clear();
+                layers[n] = populated;
+            }
+            for (size_t l = first; l < last; ++l) {
+                merged[n].insert(merged[n].end(), cells[l].begin(),
+                                 cells[l].end());
+            }
+            ++n;
+            first = last;
+        }
+        for (size_t b = 0; b < n; ++b) {
+            boxes.push_back(
+                {&merged[b], double(std::max<size_t>(1, layers[b]))});
+        }
+    }
+
+    void collide_box(const SuperparticleStore& sps, const Box& box,
+                     std::vector<SpMassTendencies>& tendencies,
+                     double dt) const {
+        const auto& p = *box.particles;
+        boxcollider.collide(indexed_iterator(sps.begin(), p.begin()),
+                            indexed_iterator(sps.begin(), p.end()),
+                            indexed_iterator(tendencies.begin(), p.begin()),
+                            dt / box.layers);
+    }
+
+    bool is_quiescent(const SuperparticleStore& sps, const Box& box,
+                      double dt) const {
+        const auto& p = *box.particles;
+        return boxcollider.activity(indexed_iterator(sps.begin(), p.begin()),
+                                    indexed_iterator(sps.begin(), p.end()),
+                                    dt / box.layers) < skip_below;
+    }
+
     C boxcollider;
+    std::unique_ptr<ThreadPool> own_pool;
+    ThreadPool& pool;
+    const double skip_below;
+    const unsigned int box_layers;
+    const std::size_t box_particles;
+    std::vector<Box> boxes;
+    std::vector<std::vector<size_t>> merged;  ///< particles of joined layers
+    std::vector<size_t> layers;  ///< populated layers of the merged boxes
+    std::vector<size_t> order;                ///< boxes to collide
+    std::size_t computed = 0;
+    std::size_t skipped = 0;
 };
 
 class NoCollisions : public Collisions {
    public:
     NoCollisions() {}
-    std::vector<SpMassTendencies> collide(const std::vector<Superparticle>& sps,
-                                          const Grid& grid,
-                                          double dt) override {
-        return std::vector<SpMassTendencies>(sps.size());
+    void collide(const SuperparticleStore& sps, const CellIndex& cells,
+                 double dt,
+                 std::vector<SpMassTendencies>& tendencies) override {
+        tendencies.clear();
+    }
+};
+
+/** \brief Monte Carlo coalescence of random superparticle pairs
+ *
+ * Shima et al. (2009): The super-droplet method for the numerical simulation
+ * of clouds and precipitation. Every step the nucleated particles of a box
+ * are shuffled into n/2 random pairs. A pair (j, k) with N_j >= N_k
+ * coalesces gamma times, an integer drawn such that its mean is
+ * N_j K dt n (n - 1) / 2 / (n / 2), K the collision kernal. Every
+ * coalescence merges N_k droplets of j into the droplets of k, the cost is
+ * O(n) per box instead of the O(n^2) of BoxCollisions. As there, N counts
+ * the droplets per unit volume. The solute of collected droplets is not
+ * tracked, the water is conserved exactly.
+ *
+ * The random numbers are Philox draws of seed, step, box and draw number,
+ * so a run is reproduced from its seed and checkpoints.
+ */
+template <typename CollisionKernal>
+class SuperDropletCollisions : public Collisions {
+   public:
+    SuperDropletCollisions(const Sedimentation& sedimentation,
+                           CollisionKernal collision_kernal,
+                           std::uint64_t seed)
+        : sedimentation(sedimentation),
+          collision_kernal(collision_kernal),
+          seed(seed) {}
+
+    void collide(const SuperparticleStore& sps, const CellIndex& cells,
+                 double dt,
+                 std::vector<SpMassTendencies>& tendencies) override {
+        ++step;
+        tendencies.assign(sps.size(), {0., 0.});
+        for (size_t l = 0; l < cells.size(); ++l) {
+            box.clear();
+            for (auto i : cells[l]) {
+                if (sps.is_nucleated[i]) {
+                    box.push_back(i);
+                }
+            }
+            size_t n = box.size();
+            if (n < 2) {
+                continue;
+            }
+            for (size_t i = n - 1; i > 0; --i) {
+                size_t k = std::min<size_t>(i, uniform(l, i) * (i + 1));
+                std::swap(box[i], box[k]);
+            }
+            double scale = 0.5 * n * (n - 1) / (n / 2) * dt;
+            for (size_t p = 0; p < n / 2; ++p) {
+                coalesce(sps, box[2 * p], box[2 * p + 1], scale,
+                         uniform(l, n + p), tendencies);
+            }
+        }
+    }
+
+    void save(CheckpointWriter& w) const override {
+        w.write(seed);
+        w.write(step);
+    }
+    void load(CheckpointReader& r) override {
+        r.read(seed);
+        r.read(step);
+    }
+
+    std::vector<std::pair<std::string, double>> counters() const override {
+        return kernal_counters(collision_kernal);
+    }
+
+   private:
+    /// uniform number draw of box in the current step
+    double uniform(size_t box, std::uint64_t draw) const {
+        auto x = Philox4x32::apply(
+            {std::uint32_t(box), std::uint32_t(draw), std::uint32_t(step),
+             std::uint32_t(step >> 32)},
+            {std::uint32_t(seed), std::uint32_t(seed >> 32)});
+        return uniform_open01(x[0], x[1]);
     }
-    bool needs_sorted_superparticles() override { return false; }
+
+    void coalesce(const SuperparticleStore& sps, size_t j, size_t k,
+                  double scale, double u,
+                  std::vector<SpMassTendencies>& tendencies) const {
+        if (sps.N[j] < sps.N[k]) {
+            std::swap(j, k);
+        }
+        double r_j = sps.radius[j];
+        double r_k = sps.radius[k];
+        double dfs = sedimentation.fall_speed(r_j) -
+                     sedimentation.fall_speed(r_k);
+        double p = sps.N[j] * scale *
+                   collision_kernal(std::min(r_j, r_k), std::max(r_j, r_k),
+                                    dfs);
+        double gamma = std::floor(p) + (u < p - std::floor(p) ? 1. : 0.);
+        gamma = std::min(gamma, std::floor(double(sps.N[j]) / sps.N[k]));
+        if (gamma <= 0.) {
+            return;
+        }
+        double N_j = sps.N[j];
+        double N_k = sps.N[k];
+        double q_j = sps.qc[j] / N_j;
+        double q_merged = sps.qc[k] / N_k + gamma * q_j;
+        if (N_j - gamma * N_k > 0.) {
+            tendencies[j] = {-gamma * N_k * q_j, -gamma * N_k};
+            tendencies[k] = {gamma * N_k * q_j, 0.};
+            return;
+        }
+        // all droplets of j are collected, the merged ones are split up
+        double N_j_new = std::floor(N_k / 2);
+        double N_k_new = N_k - N_j_new;
+        tendencies[j] = {N_j_new * q_merged - sps.qc[j], N_j_new - N_j};
+        tendencies[k] = {N_k_new * q_merged - sps.qc[k], N_k_new - N_k};
+    }
+
+    const Sedimentation& sedimentation;
+    CollisionKernal collision_kernal;
+    std::uint64_t seed;
+    std::uint64_t step = 0;
+    std::vector<size_t> box;
 };
 
-inline std::unique_ptr<Collisions> mkHCS(const Sedimentation& sedi) {
-    BoxCollisions<HallCollisionKernal<Efficiencies>> bc(sedi,
-                                          HallCollisionKernal<Efficiencies>({}));
-    return std::make_unique<
-        BoxCollisionAdapter<BoxCollisions<HallCollisionKernal<Efficiencies>>>>(bc);
+/// see BoxCollisionAdapter for the arguments after the kernal
+template <typename K>
+std::unique_ptr<Collisions> mkBoxCollisions(const Sedimentation& sedi,
+                                            K kernal,
+                                            unsigned int threads = 1,
+                                            double skip_below = 0.,
+                                            unsigned int box_layers = 1,
+                                            std::size_t box_particles = 0) {
+    return std::make_unique<BoxCollisionAdapter<BoxCollisions<K>>>(
+        BoxCollisions<K>(sedi, kernal), threads, skip_below, box_layers,
+        box_particles);
+}
+
+template <typename K>
+std::unique_ptr<Collisions> mkBoxCollisions(const Sedimentation& sedi,
+                                            K kernal, ThreadPool& pool,
+                                            double skip_below = 0.,
+                                            unsigned int box_layers = 1,
+                                            std::size_t box_particles = 0) {
+    return std::make_unique<BoxCollisionAdapter<BoxCollisions<K>>>(
+        BoxCollisions<K>(sedi, kernal), pool, skip_below, box_layers,
+        box_particles);
+}
+
+template <typename K>
+std::unique_ptr<Collisions> mkSuperDropletCollisions(const Sedimentation& sedi,
+                                                     K kernal,
+                                                     std::uint64_t seed) {
+    return std::make_unique<SuperDropletCollisions<K>>(sedi, kernal, seed);
+}
+
+inline std::unique_ptr<Collisions> mkHCS(const Sedimentation& sedi,
+                                         unsigned int threads = 1,
+                                         double skip_below = 0.,
+                                         unsigned int box_layers = 1,
+                                         std::size_t box_particles = 0) {
+    return mkBoxCollisions(sedi, HallCollisionKernal<Efficiencies>({}),
+                           threads, skip_below, box_layers, box_particles);
+}
+
+/// as above, on the threads of a pool shared with other phases
+inline std::unique_ptr<Collisions> mkHCS(const Sedimentation& sedi,
+                                         ThreadPool& pool,
+                                         double skip_below = 0.,
+                                         unsigned int box_layers = 1,
+                                         std::size_t box_particles = 0) {
+    return mkBoxCollisions(sedi, HallCollisionKernal<Efficiencies>({}), pool,
+                           skip_below, box_layers, box_particles);
+}
+
+inline std::unique_ptr<Collisions> mkSDM(const Sedimentation& sedi,
+                                         std::uint64_t seed) {
+    return mkSuperDropletCollisions(sedi, HallCollisionKernal<Efficiencies>({}),
+                                    seed);
+}
+
+/// as mkHCS and mkSDM, with the kernal tabulated, see CachedCollisionKernal
+inline std::unique_ptr<Collisions> mkCachedHCS(
+    const Sedimentation& sedi, double tolerance, double skip_below = 0.,
+    unsigned int box_layers = 1, std::size_t box_particles = 0) {
+    return mkBoxCollisions(
+        sedi,
+        CachedCollisionKernal<HallCollisionKernal<Efficiencies>>(
+            HallCollisionKernal<Efficiencies>({}), tolerance),
+        1, skip_below, box_layers, box_particles);
+}
+
+inline std::unique_ptr<Collisions> mkCachedSDM(const Sedimentation& sedi,
+                                               std::uint64_t seed,
+                                               double tolerance) {
+    return mkSuperDropletCollisions(
+        sedi,
+        CachedCollisionKernal<HallCollisionKernal<Efficiencies>>(
+            HallCollisionKernal<Efficiencies>({}), tolerance),
+        seed);
 }
 
 inline std::unique_ptr<Collisions> mkNCS() {
@@ -1,21 +1,30 @@
 #pragma once
 #include <cstdlib>
+#include <istream>
 #include <memory>
+#include <ostream>
+#include <string>
 #include "advect.h"
+#include "cell_index.h"
 #include "collision.h"
+#include "condensation.h"
+#include "diagnostics.h"
 #include "grid.h"
 #include "logger.h"
+#include "profiler.h"
 #include "radiationsolver.h"
 #include "saturation_fluctuations.h"
 #include "sedimentation.h"
 #include "state.h"
 #include "superparticle.h"
+#include "superparticle_store.h"
 #include "superparticle_source.h"
 #include "tendencies.h"
+#include "thread_pool.h"
 
 class ColumnModel {
    public:
-    typedef std::back_insert_iterator<std::vector<Superparticle>> OIt;
+    typedef SlotInsertIterator OIt;
     ColumnModel(const State& initial_state,
                 std::shared_ptr<SuperParticleSource<OIt>> source, double t_max,
                 double dt, RadiationSolver radiation_solver,
@@ -23,49 +32,82 @@ class ColumnModel {
                 std::unique_ptr<Advect> advection_solver,
                 std::unique_ptr<FluctuationSolver> fluctuations,
                 std::unique_ptr<Collisions> collisions,
-                std::unique_ptr<Sedimentation> sedimentation)
-        : source(source),
+                std::unique_ptr<Sedimentation> sedimentation,
+                std::unique_ptr<ThreadPool> pool = nullptr,
+                bool fused = false, double compaction_threshold = 0.25,
+                GrowthScheme growth = GrowthScheme::euler)
+        : pool(pool ? std::move(pool) : std::make_unique<ThreadPool>(1)),
+          channel(std::make_unique<DiagnosticChannel>()),
+          source(source),
           state(initial_state),
           superparticles{},
           dt(dt),
           t_max(t_max),
+          compaction_threshold(compaction_threshold),
           radiation_solver(radiation_solver),
           grid(std::move(grid)),
           advection_solver(std::move(advection_solver)),
           fluctuations(std::move(fluctuations)),
           collisions(std::move(collisions)),
-          sedimentation(std::move(sedimentation)){};
+          sedimentation(std::move(sedimentation)),
+          cells(*this->grid),
+          condensation(*this->sedimentation, *this->pool, fused, growth){};
     void run(std::shared_ptr<Logger> logger);
 
+    /// writes the complete model state, see checkpoint.h
+    void save_checkpoint(std::ostream& os) const;
+    /// continues from a checkpoint of a model with the same configuration,
+    /// the run continues bit for bit as the one that wrote the checkpoint
+    void load_checkpoint(std::istream& is);
+    /// writes a checkpoint to file every interval seconds of model time
+    void checkpoint_every(double interval, const std::string& file);
+    /// writes the timing report of the profiler at the end of run() to
+    /// target, a file name or stdout
+    void profile_to(const std::string& target);
+    const StepProfiler& step_profiler() const { return profiler; }
+    /// events of this model, drained by its logger, see DiagnosticScope
+    DiagnosticChannel& diagnostic_channel() { return *channel; }
+
    private:
     void log_every_seconds(std::shared_ptr<Logger> logger, double dt_out);
+    /// writes to a temporary file first, so a crash never leaves a partial
+    /// checkpoint behind
+    void write_checkpoint() const;
+    void write_profile() const;
     void step();
     bool is_running();
-    void apply_tendencies_to_superparticle(Superparticle& superparticle,
-                                           Tendencies& tendencies,
-                                           const Level& lvl);
-    void apply_tendencies_to_state(const Superparticle& superparticle,
-                                   const Tendencies& tendencies);
     void apply_collision_tendencies(
-        std::vector<Superparticle>& sps,
+        SuperparticleStore& sps,
         const std::vector<SpMassTendencies>& tendencies);
     void insert_superparticles();
-    Tendencies calc_tendencies(const Superparticle& superparticle,
-                               const double S, const double T, const double E,
-                               const double dt);
 
-    void do_condensation(State& old_state);
+    void do_condensation();
     void do_collisions();
+    /// files dead slots for reuse, compacts above compaction_threshold
+    void retire_dead();
+    /// threads of the condensation and the collisions, outlives both
+    std::unique_ptr<ThreadPool> pool;
+    std::unique_ptr<DiagnosticChannel> channel;
     std::shared_ptr<SuperParticleSource<OIt>> source;
     State state;
-    std::vector<Superparticle> superparticles;
+    SuperparticleStore superparticles;
     const double dt;
     const double t_max;
+    /// fraction of dead slots above which the superparticles are compacted
+    const double compaction_threshold;
     int runs = 0;
+    int checkpoint_steps = 0;
+    std::string checkpoint_file;
+    std::string profile_target;
+    StepProfiler profiler;
     RadiationSolver radiation_solver;
     std::unique_ptr<Grid> grid;
     std::unique_ptr<Advect> advection_solver;
     std::unique_ptr<FluctuationSolver> fluctuations;
     std::unique_ptr<Collisions> collisions;
+    /// reused by every step
+    std::vector<SpMassTendencies> collision_tendencies;
     std::unique_ptr<Sedimentation> sedimentation;
+    CellIndex cells;
+    Condensation condensation;
 };
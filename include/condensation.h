@@ -0,0 +1,74 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "saturation_fluctuations.h"
+#include "sedimentation.h"
+#include "state.h"
+#include "superparticle_store.h"
+#include "tendencies.h"
+#include "thermodynamic.h"
+#include "thread_pool.h"
+#include "validation.h"
+
+/** \brief condensation phase of one model step
+ *
+ * The superparticles are split into one contiguous chunk per thread. Every
+ * chunk adds its qv tendencies to a private per layer buffer, and the buffers
+ * are added to the state in chunk order. The result only depends on the
+ * number of threads, not on the scheduling of the chunks.
+ *
+ * The phased kernel draws all saturation fluctuations in a first pass and
+ * condenses in a second pass. The fused kernel checks the particle, draws
+ * its fluctuation, condenses, sediments and refreshes radius and liveness in
+ * a single pass over memory. Fluctuations are only drawn in parallel if the
+ * fluctuation solver is thread safe, otherwise in chunk order.
+ */
+class Condensation {
+   public:
+    Condensation(const Sedimentation& sedimentation, unsigned int threads = 1,
+                 bool fused = false, GrowthScheme growth = GrowthScheme::euler)
+        : sedimentation(sedimentation),
+          own_pool(std::make_unique<ThreadPool>(threads)),
+          pool(*own_pool),
+          fused(fused),
+          growth(growth) {}
+    /// runs on the threads of pool, which may be shared with other phases
+    Condensation(const Sedimentation& sedimentation, ThreadPool& pool,
+                 bool fused = false, GrowthScheme growth = GrowthScheme::euler)
+        : sedimentation(sedimentation),
+          pool(pool),
+          fused(fused),
+          growth(growth) {}
+
+    /// condenses all particles against the frozen layers of the state
+    void condense(State& state, SuperparticleStore& sps,
+                  FluctuationSolver& fluctuations, double dt);
+
+    unsigned int threads() const { return pool.size(); }
+    bool is_fused() const { return fused; }
+    GrowthScheme growth_scheme() const { return growth; }
+
+   private:
+    void condense_chunk(const State& state, SuperparticleStore& sps,
+                        size_t begin, size_t end, double* dqv,
+                        double& qr_ground, double dt) const;
+    void fused_chunk(const State& state, SuperparticleStore& sps,
+                     FluctuationSolver& fluctuations, size_t begin,
+                     size_t end, double* dqv, double& qr_ground,
+                     double dt) const;
+    void condense_particle(const State& state, SuperparticleRef sp, double S,
+                           double* dqv, double& qr_ground, double dt) const;
+    void apply_tendencies_to_superparticle(SuperparticleRef superparticle,
+                                           const Tendencies& tendencies,
+                                           const Level& lvl, double length,
+                                           double dt) const;
+
+    const Sedimentation& sedimentation;
+    std::unique_ptr<ThreadPool> own_pool;
+    ThreadPool& pool;
+    bool fused;
+    GrowthScheme growth;
+    std::vector<double> fluctuation;
+    std::vector<double> dqv;
+    std::vector<double> qr_ground;
+};
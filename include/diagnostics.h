@@ -0,0 +1,145 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/// rare events of the hot paths that used to be printed on the spot
+enum class Diagnostic {
+    particle_reached_ground,
+    large_drop,
+    nonpositive_collision_radius,
+    unordered_interpolation,
+};
+
+constexpr std::size_t n_diagnostics = 4;
+
+inline const char* diagnostic_name(Diagnostic d) {
+    switch (d) {
+        case Diagnostic::particle_reached_ground:
+            return "particle reached the ground, r";
+        case Diagnostic::large_drop:
+            return "large drops present, adjust droplet fall_speed function, r";
+        case Diagnostic::nonpositive_collision_radius:
+            return "R in hall_collision_kernal is zero of smaller, R";
+        case Diagnostic::unordered_interpolation:
+            return "linear interpolation: points may be in the wrong order, x1";
+    }
+    return "unknown diagnostic";
+}
+
+/** \brief lock free event counters for the hot paths
+ *
+ * report() costs one relaxed atomic increment, and for the first
+ * max_samples events of a drain interval one relaxed store of the value, so
+ * it can be called from the worker threads without stalling them. The
+ * logger drains the channel and prints one line per event type, which rate
+ * limits the output to the logging interval. Values reported while a drain
+ * is running may be attributed to the next interval.
+ */
+class DiagnosticChannel {
+   public:
+    static constexpr std::size_t max_samples = 4;
+
+    struct Summary {
+        Diagnostic event;
+        std::uint64_t count;
+        std::uint64_t total;
+        std::size_t n_samples;
+        std::array<double, max_samples> samples;
+    };
+
+    void report(Diagnostic d, double value) {
+        auto& c = counters[static_cast<std::size_t>(d)];
+        std::uint64_t n = c.count.fetch_add(1, std::memory_order_relaxed);
+        if (n < max_samples) {
+            c.samples[n].store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /// events reported since the last drain
+    std::uint64_t pending(Diagnostic d) const {
+        return counters[static_cast<std::size_t>(d)].count.load(
+            std::memory_order_relaxed);
+    }
+
+    /// calls f(summary) for every event type reported since the last drain
+    template <typename F>
+    void drain(F f) {
+        for (std::size_t i = 0; i < n_diagnostics; ++i) {
+            auto& c = counters[i];
+            std::uint64_t n = c.count.exchange(0, std::memory_order_acquire);
+            if (n == 0) {
+                continue;
+            }
+            c.total += n;
+            Summary s{static_cast<Diagnostic>(i), n, c.total,
+                      n < max_samples ? std::size_t(n) : max_samples, {}};
+            for (std::size_t k = 0; k < s.n_samples; ++k) {
+                s.samples[k] = c.samples[k].load(std::memory_order_relaxed);
+            }
+            f(s);
+        }
+    }
+
+   private:
+    struct Counter {
+        std::atomic<std::uint64_t> count{0};
+        std::array<std::atomic<double>, max_samples> samples{};
+        std::uint64_t total = 0;
+    };
+    std::array<Counter, n_diagnostics> counters;
+};
+
+/// the channel selected for the calling thread, nullptr for the default
+inline DiagnosticChannel*& selected_diagnostics() {
+    static thread_local DiagnosticChannel* channel = nullptr;
+    return channel;
+}
+
+/// the channel the model reports to: the one selected for the calling
+/// thread, see DiagnosticScope, or one channel for the process
+inline DiagnosticChannel& diagnostics() {
+    static DiagnosticChannel process;
+    DiagnosticChannel* selected = selected_diagnostics();
+    return selected ? *selected : process;
+}
+
+/** \brief selects a channel for the calling thread while it lives
+ *
+ * Every model selects its own channel for the thread that runs it, so the
+ * members of an ensemble report and drain their own events. The ThreadPool
+ * selects the channel of the caller on its workers.
+ */
+class DiagnosticScope {
+   public:
+    explicit DiagnosticScope(DiagnosticChannel& channel)
+        : previous(selected_diagnostics()) {
+        selected_diagnostics() = &channel;
+    }
+    DiagnosticScope(const DiagnosticScope&) = delete;
+    DiagnosticScope& operator=(const DiagnosticScope&) = delete;
+    ~DiagnosticScope() { selected_diagnostics() = previous; }
+
+   private:
+    DiagnosticChannel* previous;
+};
+
+inline void report(Diagnostic d, double value) { diagnostics().report(d, value); }
+
+/// drains the channel and writes one line per reported event type
+inline void print_diagnostics(std::ostream& os,
+                              DiagnosticChannel& channel = diagnostics()) {
+    channel.drain([&os](const DiagnosticChannel::Summary& s) {
+        os << diagnostic_name(s.event) << ":";
+        for (std::size_t k = 0; k < s.n_samples; ++k) {
+            os << " " << s.samples[k];
+        }
+        if (s.count > s.n_samples) {
+            os << " ...";
+        }
+        os << " (" << s.count << " times, " << s.total << " in total)"
+           << std::endl;
+    });
+}
@@ -2,8 +2,44 @@
 #include "interpolate.h"
 #include "twomey_utils.h"
 
+#include <algorithm>
 #include <array>
 
+/// radius of the collector drop R in um of the collision efficiencies of
+/// Hall (1980)
+constexpr double hall_Rref[11] = {10,  20,  30,  40,  50, 60,
+                                  70, 100, 150, 200, 300};
+/// radius ratio r/R
+constexpr double hall_rRref[20] = {0.05, 0.10, 0.15, 0.20, 0.25, 0.30, 0.35,
+                                   0.40, 0.45, 0.50, 0.55, 0.60, 0.65, 0.70,
+                                   0.75, 0.80, 0.85, 0.90, 0.95, 1.00};
+/// efficiency for hall_Rref x hall_rRref
+constexpr double hall_efficiencies[11][20] = {
+    {0.0001, 0.0001, 0.0001, 0.014, 0.017, 0.019, 0.022,
+     0.027,  0.030,  0.033,  0.035, 0.037, 0.038, 0.038,
+     0.037,  0.036,  0.035,  0.032, 0.029, 0.027},
+    {0.0001, 0.0001, 0.005, 0.016, 0.022, 0.03,  0.043,
+     0.052,  0.064,  0.072, 0.079, 0.082, 0.080, 0.076,
+     0.067,  0.057,  0.048, 0.040, 0.033, 0.027},
+    {0.0001, 0.002, 0.02, 0.04, 0.085, 0.17, 0.27, 0.40, 0.50, 0.55,
+     0.58,   0.59,  0.58, 0.54, 0.51,  0.49, 0.47, 0.45, 0.47, 0.52},
+    {0.001, 0.07, 0.28, 0.50, 0.62, 0.68, 0.74, 0.78, 0.80, 0.80,
+     0.80,  0.78, 0.77, 0.76, 0.77, 0.77, 0.78, 0.79, 0.95, 1.40},
+    {0.005, 0.40, 0.60, 0.70, 0.78, 0.83, 0.86, 0.88, 0.90, 0.90,
+     0.90,  0.90, 0.89, 0.88, 0.88, 0.89, 0.92, 1.01, 1.30, 2.30},
+    {0.05, 0.43, 0.64, 0.77, 0.84, 0.87, 0.89, 0.90, 0.91, 0.91,
+     0.91, 0.91, 0.91, 0.92, 0.93, 0.95, 1.00, 1.03, 1.70, 3.00},
+    {0.20, 0.58, 0.75, 0.84, 0.88, 0.90, 0.92, 0.94, 0.95, 0.95,
+     0.95, 0.95, 0.95, 0.95, 0.97, 1.00, 1.02, 1.04, 2.30, 4.00},
+    {0.50, 0.79, 0.91, 0.95, 0.95, 1.00, 1.00, 1.00, 1.00, 1.00,
+     1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00},
+    {0.77, 0.93, 0.97, 0.97, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00,
+     1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00},
+    {0.87, 0.96, 0.98, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00,
+     1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00},
+    {0.97, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00,
+     1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00}};
+
 class UnitEfficiencies {
    public:
     double collision_efficiency(double R, double rR) const { return 1; }
@@ -26,46 +62,112 @@ class Efficiencies {
             irR = 0;
         }
         return bi_linear_interpolate(
-            rRref[irR], Rref[iR], efficiencies[iR][irR],
-            efficiencies[iR + 1][irR], rRref[irR + 1], Rref[iR + 1],
-            efficiencies[iR][irR + 1], efficiencies[iR + 1][irR + 1], rR, R);
+            hall_rRref[irR], hall_Rref[iR], hall_efficiencies[iR][irR],
+            hall_efficiencies[iR + 1][irR], hall_rRref[irR + 1],
+            hall_Rref[iR + 1], hall_efficiencies[iR][irR + 1],
+            hall_efficiencies[iR + 1][irR + 1], rR, R);
+    }
+
+    /// collision_efficiency without branches and checks, so that loops over
+    /// it vectorize with gathers from the table. For R >= 0 the sum of the
+    /// comparisons is the bin of Rref_remap
+    double collision_efficiency_branchless(double R, double rR) const {
+        const double* R_ref = hall_Rref;
+        const double* rR_ref = hall_rRref;
+        const double* table = hall_efficiencies[0];
+        int iR = 0;
+        for (int k = 1; k < 10; ++k) {
+            iR += R_ref[k] <= R;
+        }
+        int irR = std::min(std::max(int(rR * 20 - 1), 0), 18);
+        int e = 20 * iR + irR;
+        double v1 = lerp(rR_ref[irR], table[e], rR_ref[irR + 1], table[e + 1],
+                         rR);
+        double v2 = lerp(rR_ref[irR], table[e + 20], rR_ref[irR + 1],
+                         table[e + 21], rR);
+        return lerp(R_ref[iR], v1, R_ref[iR + 1], v2, R);
     }
 
    private:
+    /// linear_interpolate without the order check
+    static double lerp(double x1, double y1, double x2, double y2, double x) {
+        double a = (y2 - y1) / (x2 - x1);
+        double b = y2 - a * x2;
+        return a * x + b;
+    }
+
     std::array<unsigned char, 31> Rref_remap = {0, 0, 1, 2, 3, 4, 5, 6, 6, 6, 7,
                                                 7, 7, 7, 7, 8, 8, 8, 8, 8, 9, 9,
                                                 9, 9, 9, 9, 9, 9, 9, 9, 9};
-    // std::vector<double> Rref;
-    // std::vector<double> rRref;
-    // std::vector<std::vector<double>> efficiencies;
+};
+
+
+/// the bilinear interpolation of one cell of UniformEfficiencies,
+/// c0 + fx c1 + fy (c2 + fx c3) for the fractions fx of R and fy of r/R
+struct EfficiencyCell {
+    double c[4];
+};
+
+constexpr int uniform_efficiency_nR = 30;   ///< nodes 10, 20, ... 300 um
+constexpr int uniform_efficiency_nrR = 20;  ///< nodes 0.05, 0.10, ... 1
 
-    double Rref[11] = {10, 20, 30, 40, 50, 60, 70, 100, 150, 200, 300};
-    double rRref[20] = {0.05, 0.10, 0.15, 0.20, 0.25, 0.30, 0.35,
-                        0.40, 0.45, 0.50, 0.55, 0.60, 0.65, 0.70,
-                        0.75, 0.80, 0.85, 0.90, 0.95, 1.00};
-    double efficiencies[11][20] = {
-        {0.0001, 0.0001, 0.0001, 0.014, 0.017, 0.019, 0.022,
-         0.027,  0.030,  0.033,  0.035, 0.037, 0.038, 0.038,
-         0.037,  0.036,  0.035,  0.032, 0.029, 0.027},
-        {0.0001, 0.0001, 0.005, 0.016, 0.022, 0.03,  0.043,
-         0.052,  0.064,  0.072, 0.079, 0.082, 0.080, 0.076,
-         0.067,  0.057,  0.048, 0.040, 0.033, 0.027},
-        {0.0001, 0.002, 0.02, 0.04, 0.085, 0.17, 0.27, 0.40, 0.50, 0.55,
-         0.58,   0.59,  0.58, 0.54, 0.51,  0.49, 0.47, 0.45, 0.47, 0.52},
-        {0.001, 0.07, 0.28, 0.50, 0.62, 0.68, 0.74, 0.78, 0.80, 0.80,
-         0.80,  0.78, 0.77, 0.76, 0.77, 0.77, 0.78, 0.79, 0.95, 1.40},
-        {0.005, 0.40, 0.60, 0.70, 0.78, 0.83, 0.86, 0.88, 0.90, 0.90,
-         0.90,  0.90, 0.89, 0.88, 0.88, 0.89, 0.92, 1.01, 1.30, 2.30},
-        {0.05, 0.43, 0.64, 0.77, 0.84, 0.87, 0.89, 0.90, 0.91, 0.91,
-         0.91, 0.91, 0.91, 0.92, 0.93, 0.95, 1.00, 1.03, 1.70, 3.00},
-        {0.20, 0.58, 0.75, 0.84, 0.88, 0.90, 0.92, 0.94, 0.95, 0.95,
-         0.95, 0.95, 0.95, 0.95, 0.97, 1.00, 1.02, 1.04, 2.30, 4.00},
-        {0.50, 0.79, 0.91, 0.95, 0.95, 1.00, 1.00, 1.00, 1.00, 1.00,
-         1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00},
-        {0.77, 0.93, 0.97, 0.97, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00,
-         1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00},
-        {0.87, 0.96, 0.98, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00,
-         1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00},
-        {0.97, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00,
-         1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00, 1.00}};
+struct UniformEfficiencyTable {
+    EfficiencyCell cells[uniform_efficiency_nR - 1]
+                        [uniform_efficiency_nrR - 1];
+};
+
+/// hall_efficiencies interpolated linearly in R to R = 10 um (k + 1)
+constexpr double uniform_efficiency_node(int k, int l) {
+    double R = 10. * (k + 1);
+    int i = 0;
+    while (i < 9 && hall_Rref[i + 1] <= R) {
+        ++i;
+    }
+    double f = (R - hall_Rref[i]) / (hall_Rref[i + 1] - hall_Rref[i]);
+    return hall_efficiencies[i][l] +
+           f * (hall_efficiencies[i + 1][l] - hall_efficiencies[i][l]);
+}
+
+constexpr UniformEfficiencyTable make_uniform_efficiency_table() {
+    UniformEfficiencyTable table{};
+    for (int k = 0; k < uniform_efficiency_nR - 1; ++k) {
+        for (int l = 0; l < uniform_efficiency_nrR - 1; ++l) {
+            double e00 = uniform_efficiency_node(k, l);
+            double e10 = uniform_efficiency_node(k + 1, l);
+            double e01 = uniform_efficiency_node(k, l + 1);
+            double e11 = uniform_efficiency_node(k + 1, l + 1);
+            EfficiencyCell& cell = table.cells[k][l];
+            cell.c[0] = e00;
+            cell.c[1] = e10 - e00;
+            cell.c[2] = e01 - e00;
+            cell.c[3] = e11 - e10 - e01 + e00;
+        }
+    }
+    return table;
+}
+
+constexpr UniformEfficiencyTable uniform_efficiency_table =
+    make_uniform_efficiency_table();
+
+/** \brief the Efficiencies resampled at compile time on a uniform grid
+ *
+ * The nodes of hall_Rref are multiples of 10 um and those of hall_rRref of
+ * 0.05, so the bilinear interpolation of the Efficiencies is bilinear on the
+ * uniform grid with these spacings as well, including the extrapolation
+ * outside of the table, and the resampling loses nothing. A lookup is two
+ * multiplies, a clamp and floor per coordinate and one blend with the
+ * coefficients of the cell, without divisions or branches.
+ */
+class UniformEfficiencies {
+   public:
+    double collision_efficiency(double R, double rR) const {
+        double x = R * 0.1 - 1.;
+        double y = rR * 20. - 1.;
+        // truncating after the clamp is the floor, without a call to floor
+        int i = int(std::min(std::max(x, 0.), uniform_efficiency_nR - 2.));
+        int j = int(std::min(std::max(y, 0.), uniform_efficiency_nrR - 2.));
+        double fx = x - i, fy = y - j;
+        const double* c = uniform_efficiency_table.cells[i][j].c;
+        return c[0] + fx * c[1] + fy * (c[2] + fx * c[3]);
+    }
 };
@@ -0,0 +1,228 @@
+#pragma once
+#include <yaml-cpp/yaml.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "logger.h"
+#include "setupcolumnmodelyaml.h"
+#include "time_stamp.h"
+#include "work_stealing_pool.h"
+
+/// one model run of an ensemble
+struct EnsembleMember {
+    std::string name;
+    std::uint64_t seed;
+    YAML::Node model;  ///< own deep copy of the model configuration
+};
+
+/// deep copy of base with the maps of overrides merged in recursively,
+/// everything else in overrides replaces the value of base
+inline YAML::Node merge_config(const YAML::Node& base,
+                               const YAML::Node& overrides) {
+    if (!overrides) {
+        return YAML::Clone(base);
+    }
+    if (!base || !base.IsMap() || !overrides.IsMap()) {
+        return YAML::Clone(overrides);
+    }
+    YAML::Node out = YAML::Clone(base);
+    for (const auto& kv : overrides) {
+        std::string key = kv.first.as<std::string>();
+        out[key] = merge_config(base[key], kv.second);
+    }
+    return out;
+}
+
+/** \brief reads the members of the ensemble section
+ *
+ * seeds: {first, count} adds count members which only differ in the seed of
+ * their random number generator. Every entry of members adds one member with
+ * a seed, an optional name and an optional model section, which is merged
+ * into the model section of the configuration. Checkpoint, restart and
+ * profile files of a member get the suffix _<name>.
+ */
+inline std::vector<EnsembleMember> createEnsemble(const YAML::Node& config) {
+    const YAML::Node& model = config["model"];
+    const YAML::Node& ensemble = config["ensemble"];
+    std::vector<EnsembleMember> members;
+    if (ensemble["seeds"]) {
+        auto first = ensemble["seeds"]["first"].as<std::uint64_t>();
+        auto count = ensemble["seeds"]["count"].as<std::uint64_t>();
+        for (auto seed = first; seed < first + count; ++seed) {
+            members.push_back(
+                {"seed_" + std::to_string(seed), seed, YAML::Clone(model)});
+        }
+    }
+    for (const auto& m : ensemble["members"]) {
+        auto seed = m["seed"].as<std::uint64_t>();
+        std::string name = m["name"] ? m["name"].as<std::string>()
+                                     : "seed_" + std::to_string(seed);
+        members.push_back({name, seed, merge_config(model, m["model"])});
+    }
+    if (members.empty()) {
+        throw std::logic_error("the ensemble has no members");
+    }
+    for (auto& m : members) {
+        const YAML::Node& model = m.model;
+        if (model["checkpoint"]) {
+            m.model["checkpoint"]["file"] =
+                model["checkpoint"]["file"].as<std::string>() + "_" + m.name;
+        }
+        if (model["restart"]) {
+            m.model["restart"] =
+                model["restart"].as<std::string>() + "_" + m.name;
+        }
+        if (model["profile"] &&
+            model["profile"].as<std::string>() != "stdout") {
+            m.model["profile"] =
+                model["profile"].as<std::string>() + "_" + m.name;
+        }
+    }
+    std::set<std::string> names;
+    for (const auto& m : members) {
+        if (!names.insert(m.name).second) {
+            throw std::logic_error("the ensemble member name: " + m.name +
+                                   " is used twice");
+        }
+    }
+    return members;
+}
+
+/// forwards to the logger of one member, one member logs at a time
+class SynchronizedLogger : public Logger {
+   public:
+    SynchronizedLogger(std::unique_ptr<Logger> logger, std::mutex& m,
+                       std::unique_ptr<std::ostream> out = nullptr)
+        : out(std::move(out)), logger(std::move(logger)), m(m) {}
+    /// the wrapped logger closes its file, which the other members must
+    /// not see half way
+    ~SynchronizedLogger() override {
+        std::lock_guard<std::mutex> lock(m);
+        logger.reset();
+        out.reset();
+    }
+
+    void initialize(const State& state, const double& dt) override {
+        std::lock_guard<std::mutex> lock(m);
+        logger->initialize(state, dt);
+    }
+    void setAttr(const std::string& key, bool val) override {
+        std::lock_guard<std::mutex> lock(m);
+        logger->setAttr(key, val);
+    }
+    void setAttr(const std::string& key, int val) override {
+        std::lock_guard<std::mutex> lock(m);
+        logger->setAttr(key, val);
+    }
+    void setAttr(const std::string& key, double val) override {
+        std::lock_guard<std::mutex> lock(m);
+        logger->setAttr(key, val);
+    }
+    void setAttr(const std::string& key, const std::string& val) override {
+        std::lock_guard<std::mutex> lock(m);
+        logger->setAttr(key, val);
+    }
+    void log(const State& state, const SuperparticleStore& superparticles,
+             const CellIndex& cells) override {
+        std::lock_guard<std::mutex> lock(m);
+        logger->log(state, superparticles, cells);
+    }
+
+   private:
+    std::unique_ptr<std::ostream> out;
+    std::unique_ptr<Logger> logger;
+    std::mutex& m;
+};
+
+/// the logger section, with the time stamp resolved once for all members
+struct EnsembleLoggerConfig {
+    std::string type;
+    std::string dir_name;
+    std::string file_name;
+};
+
+inline EnsembleLoggerConfig createEnsembleLoggerConfig(
+    const YAML::Node& config) {
+    EnsembleLoggerConfig out{config["type"].as<std::string>(),
+                             config["dir_name"].as<std::string>(),
+                             config["file_name"].as<std::string>()};
+    if (out.file_name == "time_stamp") {
+        out.file_name = time_stamp();
+    }
+    return out;
+}
+
+/// logger of one member, writing to <file_name>_<member name>. The netcdf
+/// library is not thread safe, so all member loggers share the mutex m
+inline std::unique_ptr<Logger> createMemberLogger(
+    const EnsembleLoggerConfig& config, const std::string& member,
+    std::mutex& m) {
+    std::string file_name = config.file_name + "_" + member;
+    std::lock_guard<std::mutex> lock(m);
+    if (config.type == "netcdf") {
+        return std::make_unique<SynchronizedLogger>(
+            std::make_unique<NetCDFLogger>(config.dir_name, file_name), m);
+    }
+    mkdir(config.dir_name.c_str(), S_IRWXU);
+    auto out = std::make_unique<std::ofstream>(config.dir_name + file_name +
+                                               ".txt");
+    auto logger = std::make_unique<StdoutLogger>(*out);
+    return std::make_unique<SynchronizedLogger>(std::move(logger), m,
+                                                std::move(out));
+}
+
+struct EnsembleResult {
+    std::string name;
+    bool ok;
+    std::string error;
+};
+
+/** \brief runs all members, ensemble: threads of them at a time
+ *
+ * The afglus profile and the n(s) table are loaded once from the model
+ * section and shared by all members, a member with other data paths still
+ * uses them. Every member seeds its own generator and its model reports
+ * the events of its run to its own diagnostic channel, which only its
+ * logger drains. A failing member is reported in its result and does not
+ * stop the others.
+ */
+inline std::vector<EnsembleResult> runEnsemble(
+    const YAML::Node& config, const std::vector<EnsembleMember>& members) {
+    unsigned int threads = std::thread::hardware_concurrency();
+    if (config["ensemble"]["threads"]) {
+        threads = config["ensemble"]["threads"].as<unsigned int>();
+    }
+    const ModelInputs inputs = loadModelInputs(config["model"]);
+    const EnsembleLoggerConfig logger_config =
+        createEnsembleLoggerConfig(config["logger"]);
+
+    std::mutex io;
+    std::vector<EnsembleResult> results(members.size());
+    WorkStealingPool pool(threads);
+    for (size_t i = 0; i < members.size(); ++i) {
+        results[i] = {members[i].name, false, ""};
+        pool.submit([&, i] {
+            try {
+                std::mt19937_64 gen(members[i].seed);
+                auto model = createColumnModel(gen, members[i].model, inputs);
+                std::shared_ptr<Logger> logger =
+                    createMemberLogger(logger_config, members[i].name, io);
+                model.run(logger);
+                results[i].ok = true;
+            } catch (const std::exception& e) {
+                results[i].error = e.what();
+            }
+        });
+    }
+    pool.wait();
+    return results;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <iterator>
+
+/** \brief iterates over base[idx[0]], base[idx[1]], ...
+ *
+ * Used to hand the particles of one cell of a CellIndex to algorithms written
+ * for contiguous ranges, e.g. BoxCollisions::collide.
+ */
+template <typename BaseIt, typename IdxIt>
+class IndexedIterator {
+   public:
+    typedef
+        typename std::iterator_traits<IdxIt>::difference_type difference_type;
+    typedef typename std::iterator_traits<BaseIt>::value_type value_type;
+    typedef typename std::iterator_traits<BaseIt>::reference reference;
+    typedef BaseIt pointer;
+    typedef typename std::iterator_traits<IdxIt>::iterator_category
+        iterator_category;
+
+    IndexedIterator(BaseIt base_it, IdxIt idx_it)
+        : base_it(base_it), idx_it(idx_it){};
+
+    IndexedIterator<BaseIt, IdxIt>& operator++() {
+        ++idx_it;
+        return *this;
+    }
+    IndexedIterator<BaseIt, IdxIt> operator++(int) {
+        auto that = *this;
+        ++idx_it;
+        return that;
+    }
+    IndexedIterator<BaseIt, IdxIt>& operator--() {
+        --idx_it;
+        return *this;
+    }
+    IndexedIterator<BaseIt, IdxIt> operator--(int) {
+        auto that = *this;
+        --idx_it;
+        return that;
+    }
+    reference operator*() const { return base_it[*idx_it]; }
+    pointer operator->() const { return base_it + *idx_it; }
+    reference operator[](difference_type n) const {
+        return base_it[idx_it[n]];
+    }
+    bool operator<(const IndexedIterator<BaseIt, IdxIt>& other) const {
+        return idx_it < other.idx_it;
+    }
+    bool operator<=(const IndexedIterator<BaseIt, IdxIt>& other) const {
+        return idx_it <= other.idx_it;
+    }
+    bool operator>(const IndexedIterator<BaseIt, IdxIt>& other) const {
+        return idx_it > other.idx_it;
+    }
+    bool operator>=(const IndexedIterator<BaseIt, IdxIt>& other) const {
+        return idx_it >= other.idx_it;
+    }
+    bool operator!=(const IndexedIterator<BaseIt, IdxIt>& other) const {
+        return idx_it != other.idx_it;
+    }
+    bool operator==(const IndexedIterator<BaseIt, IdxIt>& other) const {
+        return idx_it == other.idx_it;
+    }
+    IndexedIterator<BaseIt, IdxIt> operator+(difference_type n) const {
+        return {base_it, idx_it + n};
+    }
+    IndexedIterator<BaseIt, IdxIt>& operator+=(difference_type n) {
+        idx_it += n;
+        return *this;
+    }
+    IndexedIterator<BaseIt, IdxIt>& operator-=(difference_type n) {
+        idx_it -= n;
+        return *this;
+    }
+    friend IndexedIterator<BaseIt, IdxIt> operator+(
+        difference_type n, const IndexedIterator<BaseIt, IdxIt>& rhs) {
+        return rhs + n;
+    }
+    IndexedIterator<BaseIt, IdxIt> operator-(difference_type n) const {
+        return {base_it, idx_it - n};
+    }
+    difference_type operator-(
+        const IndexedIterator<BaseIt, IdxIt>& other) const {
+        return idx_it - other.idx_it;
+    }
+
+   private:
+    BaseIt base_it;
+    IdxIt idx_it;
+};
+
+template <typename BaseIt, typename IdxIt>
+IndexedIterator<BaseIt, IdxIt> indexed_iterator(BaseIt base_it, IdxIt idx_it) {
+    return {base_it, idx_it};
+}
@@ -1,9 +1,9 @@
 #pragma once
-#include <iostream>
+#include "diagnostics.h"
 
 inline double linear_interpolate(double x1, double y1, double x2, double y2, double x){
     if (x1 > x2) {
-        std::cout << "linear interpolation: points may be in the wrong order: x1 "<<  x1 << " x2 " << x2 << std::endl;
+        report(Diagnostic::unordered_interpolation, x1);
     }
     double a = ( y2 - y1 ) / ( x2 - x1 );
     double b = y2 - a * x2;
@@ -12,10 +12,10 @@ inline double linear_interpolate(double x1, double y1, double x2, double y2, dou
 
 inline double bi_linear_interpolate(double x11, double x12, double v11, double v12, double x21, double x22, double v21, double v22, double x, double y){
     if (x11 > x21) {
-        std::cout << "linear interpolation: points may be in the wrong order: x11 "<<  x11 << " x21 " << x21 << std::endl;
+        report(Diagnostic::unordered_interpolation, x11);
     }
     if (x12 > x22) {
-        std::cout << "linear interpolation: points may be in the wrong order: x12 "<<  x12 << " x22 " << x22 << std::endl;
+        report(Diagnostic::unordered_interpolation, x12);
     }
     double vinter1 =  linear_interpolate(x11, v11, x21, v21, x);
     double vinter2 =  linear_interpolate(x11, v12, x21, v22, x);
@@ -0,0 +1,202 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "diagnostics.h"
+
+/** \brief collision kernal with the radius dependence tabulated lazily
+ *
+ * The kernal has to be of the form K(r, R, dfs) = G(r, R) |dfs|, as the
+ * HallCollisionKernal. G is interpolated bilinearly between nodes on a
+ * logarithmic radius grid with bins_per_octave nodes per factor two of the
+ * radius, between r_min and r_max. The nodes are spaced linearly within
+ * every octave, so every power of two is a node. A bin of the (r, R) plane is filled on
+ * first use: its corner nodes are evaluated and kept, and the interpolation
+ * is compared with the kernal at 3 x 3 points inside of the bin. Only bins
+ * where the error stays below tolerance times the largest corner value are
+ * interpolated, all others, and radii outside the grid, are passed to the
+ * kernal. The table is reused by all boxes and steps and shared by all
+ * copies, which is not thread safe.
+ *
+ * Nodes and bins are stored in tiles of tile x tile entries, a tile is
+ * allocated when one of its entries is first used. The memory follows the
+ * radius pairs that occur, not the whole grid: the grid has about
+ * 20 / sqrt(2 tolerance) nodes per side, a full table at a tolerance of
+ * 1e-5 would take about 160 MB. Only the tile pointers, 16 bytes per
+ * tile x tile nodes, are allocated up front.
+ *
+ * Lookups served from the table count as hits, all others as misses. The
+ * cache pays off for kernals that are expensive compared to the lookup; the
+ * tabulated Efficiencies are about as cheap and have kinks on a grid that
+ * is as fine as the cache, see bench_kernels.
+ */
+template <typename K>
+class CachedCollisionKernal {
+   public:
+    CachedCollisionKernal(K kernal, double tolerance, double r_min = 1.e-8,
+                          double r_max = 1.e-2)
+        : table(std::make_shared<Table>(kernal, tolerance, r_min, r_max)) {}
+
+    double operator()(double r, double R, double dfs) const {
+        if (R <= 0.) {
+            report(Diagnostic::nonpositive_collision_radius, R);
+        }
+        return table->lookup(std::min(r, R), std::max(r, R)) * std::abs(dfs);
+    }
+
+    std::size_t hits() const { return table->hits; }
+    std::size_t misses() const { return table->misses; }
+    /// relative distance of two neighbouring nodes, at most
+    double node_spacing() const { return 1. / table->bins_per_octave; }
+    /// bytes of the node and bin tiles allocated so far
+    std::size_t allocated_bytes() const { return table->allocated_bytes(); }
+
+   private:
+    enum BinState : std::uint8_t { unknown, interpolate, direct };
+
+    struct Table {
+        static constexpr double two_52 = 4503599627370496.;
+        static constexpr std::size_t tile = 32;
+
+        Table(K kernal, double tolerance, double r_min, double r_max)
+            : kernal(kernal),
+              tolerance(tolerance),
+              bins_per_octave(
+                  std::max(1., std::ceil(1. / std::sqrt(2. * tolerance)))),
+              p_min(std::floor(position(r_min))),
+              n(std::size_t(std::ceil(position(r_max) - p_min)) + 1),
+              tiles((n + tile - 1) / tile),
+              nodes(tiles * tiles),
+              bins(tiles * tiles) {}
+
+        /// continuous, monotone and linear within every octave: the bits
+        /// of a positive double are its exponent and mantissa
+        double position(double r) const {
+            std::uint64_t bits;
+            std::memcpy(&bits, &r, sizeof(bits));
+            return bins_per_octave * (double(bits) / two_52 - 1022.);
+        }
+
+        /// inverse of position, at node i
+        double radius(double i) const {
+            double p = (i + p_min) / bins_per_octave;
+            std::uint64_t bits = std::uint64_t((p + 1022.) * two_52);
+            double r;
+            std::memcpy(&r, &bits, sizeof(r));
+            return r;
+        }
+
+        double exact(double r, double R) const { return kernal(r, R, 1.); }
+
+        /// entry (i, j) of a tiled table, allocating its tile with value
+        template <typename T>
+        T& entry(std::vector<std::unique_ptr<T[]>>& table, std::size_t i,
+                 std::size_t j, T value) {
+            auto& t = table[(i / tile) * tiles + j / tile];
+            if (!t) {
+                t.reset(new T[tile * tile]);
+                std::fill(t.get(), t.get() + tile * tile, value);
+                allocated += tile * tile * sizeof(T);
+            }
+            return t[(i % tile) * tile + j % tile];
+        }
+
+        std::size_t allocated_bytes() const { return allocated; }
+
+        double node(std::size_t i, std::size_t j) {
+            double& g = entry(nodes, i, j, -1.);
+            if (g < 0.) {
+                double r = radius(i), R = radius(j);
+                g = exact(std::min(r, R), std::max(r, R));
+            }
+            return g;
+        }
+
+        double bilinear(std::size_t i, std::size_t j, double fx, double fy) {
+            return (1. - fx) * ((1. - fy) * node(i, j) + fy * node(i, j + 1)) +
+                   fx * ((1. - fy) * node(i + 1, j) + fy * node(i + 1, j + 1));
+        }
+
+        /// compares the interpolation with the kernal inside of bin (i, j)
+        bool accurate(std::size_t i, std::size_t j) {
+            double scale = std::max({node(i, j), node(i, j + 1),
+                                     node(i + 1, j), node(i + 1, j + 1)});
+            for (double fx : {0.25, 0.5, 0.75}) {
+                for (double fy : {0.25, 0.5, 0.75}) {
+                    double r = radius(i + fx), R = radius(j + fy);
+                    double g = exact(std::min(r, R), std::max(r, R));
+                    double error = std::abs(bilinear(i, j, fx, fy) - g);
+                    if (error > tolerance * scale) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        double lookup(double r, double R) {
+            double x = position(r) - p_min;
+            double y = position(R) - p_min;
+            if (!(x >= 0. && y >= 0. && x < n - 1 && y < n - 1)) {
+                ++misses;
+                return exact(r, R);
+            }
+            std::size_t i = std::size_t(x), j = std::size_t(y);
+            auto& state = entry(bins, i, j, unknown);
+            if (state == unknown) {
+                state = accurate(i, j) ? interpolate : direct;
+                ++misses;
+                return exact(r, R);
+            }
+            if (state == direct) {
+                ++misses;
+                return exact(r, R);
+            }
+            ++hits;
+            return bilinear(i, j, x - i, y - j);
+        }
+
+        K kernal;
+        const double tolerance;
+        const double bins_per_octave;
+        const double p_min;
+        const std::size_t n;
+        const std::size_t tiles;  ///< per side
+        /// n x n, negative until evaluated
+        std::vector<std::unique_ptr<double[]>> nodes;
+        /// (n - 1) x (n - 1)
+        std::vector<std::unique_ptr<BinState[]>> bins;
+        std::size_t allocated = 0;
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+    };
+
+    std::shared_ptr<Table> table;
+};
+
+/// whether a kernal may be called from several threads at once
+template <typename K>
+struct is_thread_safe_kernal : std::true_type {};
+
+template <typename K>
+struct is_thread_safe_kernal<CachedCollisionKernal<K>> : std::false_type {};
+
+/// named counters of a collision kernal, e.g. for the profile report
+template <typename K>
+std::vector<std::pair<std::string, double>> kernal_counters(const K&) {
+    return {};
+}
+
+template <typename K>
+std::vector<std::pair<std::string, double>> kernal_counters(
+    const CachedCollisionKernal<K>& kernal) {
+    return {{"kernal_cache_hits", double(kernal.hits())},
+            {"kernal_cache_misses", double(kernal.misses())}};
+}
@@ -12,9 +12,12 @@
 #include <string>
 #include "state.h"
 #include "superparticle.h"
+#include "superparticle_store.h"
 #include "grid.h"
 #include "thermodynamic.h"
 #include "analize_sp.h"
+#include "cell_index.h"
+#include "diagnostics.h"
 #include "analize_state.h"
 #include "time_stamp.h"
 #include "member_iterator.h"
@@ -27,42 +30,50 @@ class Logger {
     virtual void setAttr(const std::string& key, double val){}
     virtual void setAttr(const std::string& key, const std::string& val){}
     virtual void log(const State& state,
-                     const std::vector<Superparticle>& superparticles
+                     const SuperparticleStore& superparticles,
+                     const CellIndex& cells
                     ) = 0;
     virtual ~Logger(){}
 };
 
 class StdoutLogger : public Logger {
    public:
+    explicit StdoutLogger(std::ostream& os = std::cout) : os(os) {}
+
     inline void log(const State& state,
-                    const std::vector<Superparticle>& superparticles
+                    const SuperparticleStore& superparticles,
+                     const CellIndex& cells
                     )  override {
-        std::vector<double> qc_sum = calculate_qc_profile(superparticles, state.grid);
-        std::vector<double> r_mean = calculate_mean_radius_profile(superparticles, state.grid);
-        std::vector<double> r_max = calculate_maximal_radius_profile(superparticles, state.grid);
-        std::vector<int> sp_count_nuc = count_nucleated(superparticles, state.grid);
+        std::vector<double> qc_sum = calculate_qc_profile(superparticles, cells);
+        std::vector<double> r_mean = calculate_mean_radius_profile(superparticles, cells);
+        std::vector<double> r_max = calculate_maximal_radius_profile(superparticles, cells);
+        std::vector<int> sp_count_nuc = count_nucleated(superparticles, cells);
         std::vector<double> S = supersaturation_profile(state);
 
-        std::cout << std::endl;
-        std::cout << "State at " << state.t << "\n";
-        std::cout << "     layer         z         E         p         T       "
+        os << std::endl;
+        os << "State at " << state.t << "\n";
+        os << "     layer         z         E         p         T       "
                      " qv         S        qc    r_mean     r_max     N_nuc\n";
         for (unsigned int i = 0; i < state.layers.size(); ++i) {
-            std::cout << std::setprecision(3) << std::setw(10) << i;
-            std::cout << std::setprecision(3) << std::setw(10) << state.grid.getlay(i);
-            std::cout << std::setprecision(3) << std::setw(10) << state.layers[i].E;
-            std::cout << std::setprecision(3) << std::setw(10) << state.layers[i].p;
-            std::cout << std::setprecision(3) << std::setw(10) << state.layers[i].T;
-            std::cout << std::setprecision(3) << std::setw(10) << state.layers[i].qv;
-            std::cout << std::setprecision(3) << std::setw(10) << S[i];
-            std::cout << std::setprecision(3) << std::setw(10) << qc_sum[i];
-            std::cout << std::setprecision(3) << std::setw(10) << r_mean[i];
-            std::cout << std::setprecision(3) << std::setw(10) << r_max[i];
-            std::cout << std::setprecision(3) << std::setw(10) << sp_count_nuc[i];
-            std::cout << "\n";
+            os << std::setprecision(3) << std::setw(10) << i;
+            os << std::setprecision(3) << std::setw(10) << state.grid.getlay(i);
+            os << std::setprecision(3) << std::setw(10) << state.layers[i].E;
+            os << std::setprecision(3) << std::setw(10) << state.layers[i].p;
+            os << std::setprecision(3) << std::setw(10) << state.layers[i].T;
+            os << std::setprecision(3) << std::setw(10) << state.layers[i].qv;
+            os << std::setprecision(3) << std::setw(10) << S[i];
+            os << std::setprecision(3) << std::setw(10) << qc_sum[i];
+            os << std::setprecision(3) << std::setw(10) << r_mean[i];
+            os << std::setprecision(3) << std::setw(10) << r_max[i];
+            os << std::setprecision(3) << std::setw(10) << sp_count_nuc[i];
+            os << "\n";
         }
-        std::cout << std::endl;
+        os << std::endl;
+        print_diagnostics(os);
     }
+
+   private:
+    std::ostream& os;
 };
 
 class NetCDFLogger: public Logger {
@@ -131,17 +142,18 @@ class NetCDFLogger: public Logger {
     }
 
     inline void log(const State& state,
-                    const std::vector<Superparticle>& superparticles
+                    const SuperparticleStore& superparticles,
+                     const CellIndex& cells
                     ) override {
 
 
-        auto qc = calculate_qc_profile(superparticles, state.grid);
+        auto qc = calculate_qc_profile(superparticles, cells);
         auto S = supersaturation_profile(state);
-        auto r_max = calculate_maximal_radius_profile(superparticles, state.grid);
-        auto r_mean = calculate_mean_radius_profile(superparticles, state.grid);
-        auto ccn_count = count_nucleated_ccn(superparticles, state.grid);
-        auto ccn_count_falling = count_falling_ccn(superparticles, state.grid);
-        auto r_std = calculate_stddev_radius_profile(superparticles, state.grid);
+        auto r_max = calculate_maximal_radius_profile(superparticles, cells);
+        auto r_mean = calculate_mean_radius_profile(superparticles, cells);
+        auto ccn_count = count_nucleated_ccn(superparticles, cells);
+        auto ccn_count_falling = count_falling_ccn(superparticles, cells);
+        auto r_std = calculate_stddev_radius_profile(superparticles, cells);
         std::vector<double> qv(member_iterator(const_cast<State&>(state).layers.begin(), &Layer::qv), 
                                member_iterator(const_cast<State&>(state).layers.end(), &Layer::qv));
         std::vector<double> T(member_iterator(const_cast<State&>(state).layers.begin(), &Layer::T), 
@@ -166,7 +178,8 @@ class NetCDFLogger: public Logger {
             sum += q;
         }
         std::cout << "qc sum: " << sum << std::endl;
-        std::cout << "sp size: " << superparticles.size() << std::endl;
+        std::cout << "sp size: " << superparticles.n_live() << std::endl;
+        print_diagnostics(std::cout);
         ++i;
     }
 
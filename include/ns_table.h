@@ -12,12 +12,22 @@
 
 void load_data(std::vector<double>& n, std::vector<double>& s);
 
+/// the n(s) table of the twomey activation, see load_data
+struct NsData {
+    std::vector<double> n;
+    std::vector<double> s;
+};
+
+NsData load_ns_data();
+
 void set_n(std::vector<double>& n_out, const std::vector<double>& n, double N);
 
 std::vector<double> calculate_stable(const std::vector<double>& n, const std::vector<double>& s, const std::vector<double>& nx);
 
 std::vector<double> nstable(int N, int& Nmulti);
 
+std::vector<double> nstable(const NsData& data, int N, int& Nmulti);
+
 template <typename T, typename U, typename V>
 std::vector<double> arange(T start, U stop, V step){
     std::vector<double> out;
@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include "constants.h"
+
+/** \brief Philox4x32-10 counter based random number generator
+ *
+ * Salmon et al. (2011): Parallel random numbers: as easy as 1, 2, 3. The
+ * output is a bijection of the counter for every key, so every (key, counter)
+ * pair yields an independent draw without any state to share between threads.
+ */
+struct Philox4x32 {
+    typedef std::array<std::uint32_t, 4> ctr_type;
+    typedef std::array<std::uint32_t, 2> key_type;
+
+    static ctr_type apply(ctr_type ctr, key_type key) {
+        for (int r = 0; r < 10; ++r) {
+            if (r > 0) {
+                key[0] += 0x9E3779B9;
+                key[1] += 0xBB67AE85;
+            }
+            ctr = round(ctr, key);
+        }
+        return ctr;
+    }
+
+   private:
+    static ctr_type round(const ctr_type& ctr, const key_type& key) {
+        std::uint64_t p0 = std::uint64_t(0xD2511F53) * ctr[0];
+        std::uint64_t p1 = std::uint64_t(0xCD9E8D57) * ctr[2];
+        return {std::uint32_t(p1 >> 32) ^ ctr[1] ^ key[0], std::uint32_t(p1),
+                std::uint32_t(p0 >> 32) ^ ctr[3] ^ key[1], std::uint32_t(p0)};
+    }
+};
+
+/// uniform double in (0, 1) from 64 random bits
+inline double uniform_open01(std::uint32_t hi, std::uint32_t lo) {
+    std::uint64_t bits = (std::uint64_t(hi) << 32 | lo) >> 11;
+    return (bits + 0.5) / 9007199254740992.;  // 2^53
+}
+
+/// standard normal draw number counter of stream, for the given seed
+inline double philox_normal(std::uint64_t seed, std::uint64_t stream,
+                            std::uint64_t counter) {
+    auto x = Philox4x32::apply(
+        {std::uint32_t(stream), std::uint32_t(stream >> 32),
+         std::uint32_t(counter), std::uint32_t(counter >> 32)},
+        {std::uint32_t(seed), std::uint32_t(seed >> 32)});
+    double u1 = uniform_open01(x[0], x[1]);
+    double u2 = uniform_open01(x[2], x[3]);
+    return std::sqrt(-2. * std::log(u1)) * std::cos(2. * PI * u2);
+}
@@ -0,0 +1,239 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "cell_index.h"
+#include "superparticle_store.h"
+
+/** \brief phases of ColumnModel::run that are timed by the StepProfiler
+ *
+ * bookkeeping covers retire_dead and the cell index update, validation the
+ * checks of the Validator.
+ */
+enum class Phase {
+    advection,
+    fluctuations,
+    generation,
+    condensation,
+    collisions,
+    bookkeeping,
+    validation,
+    radiation,
+    logging,
+    checkpoint,
+};
+
+constexpr std::size_t n_phases = 10;
+
+/// named values, totals of the run, e.g. cache hits, or counts of a step
+typedef std::vector<std::pair<std::string, double>> ProfileCounters;
+
+inline const char* phase_name(Phase p) {
+    switch (p) {
+        case Phase::advection:
+            return "advection";
+        case Phase::fluctuations:
+            return "fluctuations";
+        case Phase::generation:
+            return "generation";
+        case Phase::condensation:
+            return "condensation";
+        case Phase::collisions:
+            return "collisions";
+        case Phase::bookkeeping:
+            return "bookkeeping";
+        case Phase::validation:
+            return "validation";
+        case Phase::radiation:
+            return "radiation";
+        case Phase::logging:
+            return "logging";
+        case Phase::checkpoint:
+            return "checkpoint";
+    }
+    return "unknown";
+}
+
+#ifndef COLUMNMODEL_PROFILE
+#define COLUMNMODEL_PROFILE 1
+#endif
+
+/// nearest rank percentile q in [0, 1] of the samples, 0 without samples
+inline double percentile(std::vector<double> samples, double q) {
+    if (samples.empty()) {
+        return 0.;
+    }
+    std::size_t k = std::min(samples.size() - 1,
+                             std::size_t(q * (samples.size() - 1) + 0.5));
+    std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+    return samples[k];
+}
+
+/** \brief wall time per phase and step, superparticle count and occupancy
+ *
+ * A Scope adds the time between its construction and destruction to a phase
+ * of the current step, end_step() stores the step as one sample per phase,
+ * so percentiles are over steps. count() samples named counts of the
+ * current step, e.g. the collision boxes, reported the same way. Costs two clock reads per phase
+ * and step. The profiler is compiled out with COLUMNMODEL_PROFILE=0 (see
+ * the PROFILE cmake option), which selects the empty specialization.
+ */
+template <bool Enabled>
+class BasicStepProfiler {
+    typedef std::chrono::steady_clock Clock;
+
+   public:
+    class Scope {
+       public:
+        Scope(BasicStepProfiler& profiler, Phase phase)
+            : profiler(profiler), phase(phase), start(Clock::now()) {}
+        ~Scope() {
+            profiler.current[static_cast<std::size_t>(phase)] +=
+                std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+       private:
+        BasicStepProfiler& profiler;
+        Phase phase;
+        Clock::time_point start;
+    };
+
+    /// adds named counts to the current step, once per step and name
+    void count(const ProfileCounters& counts) {
+        for (const auto& c : counts) {
+            auto it = std::find_if(
+                step_counts.begin(), step_counts.end(),
+                [&c](const NamedSamples& s) { return s.first == c.first; });
+            if (it == step_counts.end()) {
+                step_counts.push_back({c.first, {}});
+                it = step_counts.end() - 1;
+            }
+            it->second.push_back(c.second);
+        }
+    }
+
+    void end_step(const SuperparticleStore& sps, const CellIndex& cells) {
+        for (std::size_t p = 0; p < n_phases; ++p) {
+            samples[p].push_back(current[p]);
+            current[p] = 0.;
+        }
+        superparticles.push_back(sps.n_live());
+        occupancy_sum.resize(cells.size(), 0.);
+        occupancy_max.resize(cells.size(), 0);
+        for (std::size_t l = 0; l < cells.size(); ++l) {
+            occupancy_sum[l] += cells[l].size();
+            occupancy_max[l] = std::max(occupancy_max[l], cells[l].size());
+        }
+    }
+
+    std::size_t steps() const { return superparticles.size(); }
+
+    /// time of phase p in every step
+    const std::vector<double>& phase_samples(Phase p) const {
+        return samples[static_cast<std::size_t>(p)];
+    }
+
+    /// samples of the named count in every step it was counted
+    const std::vector<double>& count_samples(const std::string& name) const {
+        static const std::vector<double> none;
+        for (const auto& s : step_counts) {
+            if (s.first == name) {
+                return s.second;
+            }
+        }
+        return none;
+    }
+
+    /// writes the report as json
+    void report(std::ostream& os, const ProfileCounters& counters = {}) const {
+        std::array<double, n_phases> totals{};
+        double total = 0;
+        for (std::size_t p = 0; p < n_phases; ++p) {
+            for (double t : samples[p]) {
+                totals[p] += t;
+            }
+            total += totals[p];
+        }
+        os << std::setprecision(6) << "{\n  \"steps\": " << steps()
+           << ",\n  \"total_seconds\": " << total << ",\n  \"phases\": {";
+        for (std::size_t p = 0; p < n_phases; ++p) {
+            os << (p ? "," : "") << "\n    \""
+               << phase_name(static_cast<Phase>(p)) << "\": {";
+            distribution(os, samples[p]);
+            os << ", \"total\": " << totals[p] << ", \"fraction\": "
+               << (total > 0 ? totals[p] / total : 0.) << "}";
+        }
+        os << "\n  },\n  \"superparticles\": {";
+        distribution(os, superparticles);
+        os << "},\n  \"layer_occupancy\": {\n    \"mean\": [";
+        for (std::size_t l = 0; l < occupancy_sum.size(); ++l) {
+            os << (l ? ", " : "")
+               << occupancy_sum[l] / std::max<std::size_t>(1, steps());
+        }
+        os << "],\n    \"max\": [";
+        for (std::size_t l = 0; l < occupancy_max.size(); ++l) {
+            os << (l ? ", " : "") << occupancy_max[l];
+        }
+        os << "]\n  },\n  \"step_counters\": {";
+        for (std::size_t c = 0; c < step_counts.size(); ++c) {
+            double sum = 0;
+            for (double x : step_counts[c].second) {
+                sum += x;
+            }
+            os << (c ? "," : "") << "\n    \"" << step_counts[c].first
+               << "\": {";
+            distribution(os, step_counts[c].second);
+            os << ", \"total\": " << sum << "}";
+        }
+        os << "\n  },\n  \"counters\": {" << std::setprecision(15);
+        for (std::size_t c = 0; c < counters.size(); ++c) {
+            os << (c ? ", " : "") << "\"" << counters[c].first
+               << "\": " << counters[c].second;
+        }
+        os << "}\n}\n";
+    }
+
+   private:
+    static void distribution(std::ostream& os, const std::vector<double>& s) {
+        double mean = 0;
+        for (double x : s) {
+            mean += x;
+        }
+        mean /= std::max<std::size_t>(1, s.size());
+        os << "\"mean\": " << mean << ", \"p50\": " << percentile(s, 0.5)
+           << ", \"p90\": " << percentile(s, 0.9)
+           << ", \"p99\": " << percentile(s, 0.99)
+           << ", \"max\": " << percentile(s, 1.);
+    }
+
+    typedef std::pair<std::string, std::vector<double>> NamedSamples;
+
+    std::array<double, n_phases> current{};
+    std::array<std::vector<double>, n_phases> samples;
+    std::vector<double> superparticles;
+    std::vector<double> occupancy_sum;
+    std::vector<std::size_t> occupancy_max;
+    std::vector<NamedSamples> step_counts;
+};
+
+template <>
+class BasicStepProfiler<false> {
+   public:
+    struct Scope {
+        Scope(BasicStepProfiler& profiler, Phase phase) {}
+    };
+    void count(const ProfileCounters& counts) {}
+    void end_step(const SuperparticleStore& sps, const CellIndex& cells) {}
+    std::size_t steps() const { return 0; }
+    void report(std::ostream& os, const ProfileCounters& counters = {}) const {
+        os << "{\"steps\": 0, \"disabled\": true}\n";
+    }
+};
+
+typedef BasicStepProfiler<COLUMNMODEL_PROFILE != 0> StepProfiler;
@@ -6,15 +6,19 @@
 #include <iostream>
 #include <iterator>
 #include <iterator>
+#include <mutex>
 #include <string>
 #include <vector>
 #include "backgroundlevel.h"
+#include "checkpoint.h"
 #include "fpda_rrtm_lw_cld.h"
 #include "fpda_rrtm_sw_cld.h"
+#include "cell_index.h"
 #include "grid.h"
 #include "readatm_utils.h"
 #include "state.h"
 #include "superparticle.h"
+#include "superparticle_store.h"
 
 template <typename IIt, typename IIt2>
 std::vector<double> concatonate(IIt a_first, IIt a_last, IIt2 b_first,
@@ -27,13 +31,13 @@ std::vector<double> concatonate(IIt a_first, IIt a_last, IIt2 b_first,
 }
 
 static inline void calculate_cloudproperties(
-    const std::vector<Superparticle>& superparticles, const Grid& grid,
-    std::vector<double>& cliqwp, std::vector<double>& reliq) {
+    const SuperparticleStore& superparticles, const CellIndex& cells,
+    const Grid& grid, std::vector<double>& cliqwp, std::vector<double>& reliq) {
     std::vector<double> lvls = grid.getlvls();
 
-    std::vector<double> qc_sum = calculate_qc_profile(superparticles, grid);
+    std::vector<double> qc_sum = calculate_qc_profile(superparticles, cells);
     std::vector<double> r_eff =
-        calculate_effective_radius_profile(superparticles, grid);
+        calculate_effective_radius_profile(superparticles, cells);
 
     std::transform(qc_sum.begin(), qc_sum.end(), qc_sum.begin(),
                    std::bind(std::multiplies<void>(), std::placeholders::_1,
@@ -60,12 +64,22 @@ static inline void calculate_cloudproperties(
                     [re_max](double a) { return (a > re_max); }, re_max);
 }
 
+inline std::vector<BackgroundLevelAfglus> read_afglus(
+    const std::string& filename) {
+    std::ifstream ifs(filename);
+    std::vector<BackgroundLevelAfglus> bglvl;
+    readin_atm<BackgroundLevelAfglus>(ifs, std::back_inserter(bglvl));
+    return bglvl;
+}
+
 struct RadiationSolver {
-    RadiationSolver(std::string filename, bool sw, bool lw): sw(sw), lw(lw) {
-        std::ifstream ifs(filename);
-        std::vector<BackgroundLevelAfglus> bglvl;
-        readin_atm<BackgroundLevelAfglus>(ifs, std::back_inserter(bglvl));
+    RadiationSolver(std::string filename, bool sw, bool lw)
+        : RadiationSolver(read_afglus(filename), sw, lw) {}
 
+    /// takes an already parsed afglus profile, see read_afglus
+    RadiationSolver(const std::vector<BackgroundLevelAfglus>& bglvl, bool sw,
+                    bool lw)
+        : sw(sw), lw(lw) {
         z = get_quantity(bglvl, &BackgroundLevelAfglus::z);
         p = get_quantity(bglvl, &BackgroundLevelAfglus::p);
         T = get_quantity(bglvl, &BackgroundLevelAfglus::T);
@@ -96,13 +110,34 @@ struct RadiationSolver {
         co2 = pairwise_mean(co2);
     }
 
+    /// the profiles are read from the configuration again on restart, only
+    /// the input prepared on the first call is saved
+    void save(CheckpointWriter& w) const {
+        w.section("RAD ");
+        w.write(first);
+        w.write(nlay);
+        w.write(index);
+        w.write(p_lvl_app);
+        w.write(T_lay_app);
+    }
+
+    void load(CheckpointReader& r) {
+        r.section("RAD ");
+        r.read(first);
+        r.read(nlay);
+        r.read(index);
+        r.read(p_lvl_app);
+        r.read(T_lay_app);
+    }
+
     void init(Logger& logger){
         logger.setAttr("sw", sw);
         logger.setAttr("lw", lw);
     }
 
     void calculate_radiation(State& state,
-                             const std::vector<Superparticle>& superparticles
+                             const SuperparticleStore& superparticles,
+                             const CellIndex& cells
                              ) {
         if (lw || sw) {
             if (first) {
@@ -132,8 +167,12 @@ struct RadiationSolver {
             double** hrlw;
             double** hrsw;
 
-            calculate_cloudproperties(superparticles, state.grid, cliqwp, reliq);
+            calculate_cloudproperties(superparticles, cells, state.grid, cliqwp, reliq);
 
+            // rrtm keeps its state in fortran modules, concurrent models
+            // (see ensemble.h) must not call it at the same time
+            static std::mutex rrtm;
+            std::lock_guard<std::mutex> lock(rrtm);
             if (lw) {
                 cfpda_rrtm_lw_cld(
                     1, nlay, p_lvl_app.data(), T_lay_app.data(), h2o.data(),
@@ -206,7 +245,7 @@ struct RadiationSolver {
     std::vector<double> co2;
     std::vector<double> no2;
     std::vector<double> air;
-    int index;
-    int nlay;
+    int index = 0;
+    int nlay = 0;
     bool first = true;
 };
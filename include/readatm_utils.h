@@ -31,8 +31,12 @@ void readin_atm(IFS& ifs, OI oi) {
 template <typename Container, typename Element>
 std::vector<Element> get_quantity(Container& c,
                                   Element Container::value_type::*mem_ptr) {
-    return std::vector<Element>(member_iterator(c.begin(), mem_ptr),
-                                member_iterator(c.end(), mem_ptr));
+    std::vector<Element> out;
+    out.reserve(c.size());
+    for (const auto& el : c) {
+        out.push_back(el.*mem_ptr);
+    }
+    return out;
 }
 
 template <typename Container>
@@ -1,7 +1,9 @@
 #pragma once
 #include <limits>
 #include <random>
-#include "superparticle.h"
+#include "checkpoint.h"
+#include "philox.h"
+#include "superparticle_store.h"
 #include "constants.h"
 #include "tau_relax.h"
 
@@ -17,13 +19,21 @@ inline double integral_timescale(const double& l, const double& tke) {
     return l / std::pow(2. * PI, 1./3.) * std::sqrt(c / tke);
 }
 
+/// one step of the process, xi is a standard normal draw
+inline double ornstein_uhlenbeck_update(const double& w, const double& dt,
+                                        const double& tau,
+                                        const double& w_std,
+                                        const double& xi) {
+    return w * std::exp(-dt / tau) +
+           std::sqrt(1 - std::exp(-2 * dt / tau)) * w_std * xi;
+}
+
 template <typename G>
 double ornstein_uhlenbeck_process(G& gen,const double& w, const double& dt,
                                          const double& tau,
                                          const double& w_std) {
     std::normal_distribution<> d(0., 1.);
-    return w * std::exp(-dt / tau) +
-           std::sqrt(1 - std::exp(-2 * dt / tau)) * w_std * d(gen);
+    return ornstein_uhlenbeck_update(w, dt, tau, w_std, d(gen));
 }
 
 inline double saturation_fluctuations(const double& w_prime, const double& dt,
@@ -35,38 +45,68 @@ inline double saturation_fluctuations(const double& w_prime, const double& dt,
 
 class FluctuationSolver {
    public:
-    virtual void refresh(const std::vector<Superparticle>& sp) = 0;
-    virtual double getFluctuation(Superparticle& s, const double& dt) = 0;
+    virtual void refresh(const SuperparticleStore& sp, const CellIndex& cells) = 0;
+    virtual double getFluctuation(SuperparticleRef s, const double& dt) = 0;
+    /// true if getFluctuation may be called for different particles at once
+    virtual bool is_thread_safe() const { return false; }
+    /// state that has to survive a restart, see checkpoint.h
+    virtual void save(CheckpointWriter& w) const {}
+    virtual void load(CheckpointReader& r) {}
 };
 
+/** \brief Ornstein-Uhlenbeck updraft fluctuations per superparticle
+ *
+ * The random number of a particle is a Philox draw keyed by the seed, the id
+ * of the particle and the number of refreshes, so it does not depend on the
+ * order or the partitioning of the particles. The seed is taken from gen on
+ * construction.
+ */
 template <typename G>
 class MarkovFluctuationSolver : public FluctuationSolver {
    public:
     MarkovFluctuationSolver(G& gen, const double& epsilon, double l, const Grid& grid)
-        : epsilon(epsilon), l(l), gen(gen), tau_relax(grid) {}
-    void refresh(const std::vector<Superparticle>& sp) override;
-    double getFluctuation(Superparticle& s, const double& dt) override;
+        : epsilon(epsilon),
+          l(l),
+          tke(turbulent_kinetic_energy(l, epsilon)),
+          tau(integral_timescale(l, tke)),
+          w_std(w_standart(tke)),
+          seed(gen()),
+          tau_relax(grid) {}
+    void refresh(const SuperparticleStore& sp, const CellIndex& cells) override;
+    double getFluctuation(SuperparticleRef s, const double& dt) override;
+    bool is_thread_safe() const override { return true; }
+    void save(CheckpointWriter& w) const override {
+        w.write(seed);
+        w.write(step);
+    }
+    void load(CheckpointReader& r) override {
+        r.read(seed);
+        r.read(step);
+    }
 
    private:
     const double epsilon;
     const double l;
-    G& gen;
+    const double tke;
+    const double tau;
+    const double w_std;
+    std::uint64_t seed;
+    std::uint64_t step = 0;
     TauRelax tau_relax;
 };
 
 template <typename G>
-void MarkovFluctuationSolver<G>::refresh(
-    const std::vector<Superparticle>& sp) {
-    tau_relax.refresh(sp);
+void MarkovFluctuationSolver<G>::refresh(const SuperparticleStore& sp,
+                                         const CellIndex& cells) {
+    tau_relax.refresh(sp, cells);
+    ++step;
 }
 
 template <typename G>
-double MarkovFluctuationSolver<G>::getFluctuation(Superparticle& s,
+double MarkovFluctuationSolver<G>::getFluctuation(SuperparticleRef s,
                                                       const double& dt) {
-    double tke = turbulent_kinetic_energy(l, epsilon);
-    double tau = integral_timescale(l, tke);
-    double w_std = w_standart(tke);
-    s.w_prime = ornstein_uhlenbeck_process(gen, s.w_prime, dt, tau, w_std);
+    double xi = philox_normal(seed, s.id, step);
+    s.w_prime = ornstein_uhlenbeck_update(s.w_prime, dt, tau, w_std, xi);
     double tau_r = tau_relax(s.z);
     s.S_prime = saturation_fluctuations(s.w_prime, dt, tau_r, s.S_prime);
     return s.S_prime;
@@ -75,8 +115,9 @@ double MarkovFluctuationSolver<G>::getFluctuation(Superparticle& s,
 class NoFluctuationSolver : public FluctuationSolver {
    public:
     NoFluctuationSolver(){}
-    void refresh(const std::vector<Superparticle>& sp) override {}
-    double getFluctuation(Superparticle& s, const double& dt) override {return 0.;}
+    void refresh(const SuperparticleStore& sp, const CellIndex& cells) override {}
+    double getFluctuation(SuperparticleRef s, const double& dt) override {return 0.;}
+    bool is_thread_safe() const override { return true; }
 };
 
 template <typename G>
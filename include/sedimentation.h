@@ -2,38 +2,92 @@
 #include "thermodynamic.h"
 #include "twomey_utils.h"
 #include "interpolate.h"
+#include <algorithm>
+#include <cstddef>
 #include <vector>
 #include <memory>
 
 class Sedimentation{
     public:
     virtual double fall_speed(double r) const = 0;
+    /// fall speeds v[i] of the radii r[i], i < n
+    virtual void fall_speed(const double* r, double* v, std::size_t n) const {
+        for (std::size_t i = 0; i < n; ++i) {
+            v[i] = fall_speed(r[i]);
+        }
+    }
  };
 
+/// terminal fall speeds in m/s over the drop diameter in mm
+constexpr double fall_speed_diameters[34] = {
+    0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0, 1.2, 1.4,
+    1.6, 1.8, 2.0, 2.2, 2.4, 2.6, 2.8, 3.0, 3.2, 3.4, 3.6, 3.8,
+    4.0, 4.2, 4.4, 4.6, 4.8, 5.0, 5.2, 5.4, 5.6, 5.8};
+constexpr double fall_speed_values[34] = {
+    0.27, 0.72, 1.17, 1.62, 2.06, 2.47, 2.87, 3.27, 3.67, 4.03, 4.64, 5.17,
+    5.65, 6.09, 6.49, 6.90, 7.27, 7.57, 7.82, 8.06, 8.26, 8.44, 8.60, 8.72,
+    8.83, 8.92, 8.98, 9.03, 9.07, 9.09, 9.12, 9.14, 9.16, 9.17};
+
+constexpr double uniform_fall_speed_dr = 5.e-5;  ///< m
+constexpr int uniform_fall_speed_n = 58;  ///< cells from 0 to 2.9 mm
+
+/// the cells of FallSpeedLU, c0 + f (c1 + f c2) for the fraction f of the
+/// radius in the cell, as columns for the gathers of the batch version
+struct UniformFallSpeedTable {
+    double c0[uniform_fall_speed_n];
+    double c1[uniform_fall_speed_n];
+    double c2[uniform_fall_speed_n];
+};
+
+/// fall_speed_values interpolated linearly to the diameter 0.1 mm k
+constexpr double uniform_fall_speed_node(int k) {
+    double d = 0.1 * k;
+    int i = 0;
+    while (i < 32 && fall_speed_diameters[i + 1] <= d) {
+        ++i;
+    }
+    double f = (d - fall_speed_diameters[i]) /
+               (fall_speed_diameters[i + 1] - fall_speed_diameters[i]);
+    return fall_speed_values[i] +
+           f * (fall_speed_values[i + 1] - fall_speed_values[i]);
+}
+
+constexpr UniformFallSpeedTable make_uniform_fall_speed_table() {
+    UniformFallSpeedTable table{};
+    // below the smallest drop the speed is 1.19e8 m^-1 s^-1 r^2
+    table.c2[0] = 1.19e8 * uniform_fall_speed_dr * uniform_fall_speed_dr;
+    for (int k = 1; k < uniform_fall_speed_n; ++k) {
+        table.c0[k] = uniform_fall_speed_node(k);
+        table.c1[k] = uniform_fall_speed_node(k + 1) - table.c0[k];
+    }
+    return table;
+}
+
+constexpr UniformFallSpeedTable uniform_fall_speed_table =
+    make_uniform_fall_speed_table();
+
+/** \brief fall speeds interpolated linearly from measured ones
+ *
+ * The measured diameters are multiples of 0.1 mm, so the table is resampled
+ * at compile time on a uniform radius grid with a spacing of 50 um without
+ * loss, including the extrapolation above the largest drop. Below the
+ * smallest drop the speed grows with the radius squared, which is the first
+ * cell of the grid. A lookup is a multiply, a clamp and one polynomial,
+ * without divisions, searches or branches, the speed is at most 10 m/s.
+ */
 class FallSpeedLU: public Sedimentation{
     public:
-    FallSpeedLU(){
-        r = {0.1, 0.2, 0.3, 0.4, 0.5 ,0.6, 0.7, 0.8, 0.9, 1.0, 1.2, 1.4, 1.6, 1.8, 2.0, 2.2, 2.4,
-             2.6, 2.8, 3.0, 3.2, 3.4, 3.6, 3.8, 4.0, 4.2, 4.4, 4.6, 4.8, 5.0, 5.2, 5.4, 5.6, 5.8};
-        std::transform(r.begin(), r.end(), r.begin(), [](double x){return x/2000.;});
-        v = {0.27, 0.72, 1.17, 1.62, 2.06, 2.47, 2.87, 3.27, 3.67, 4.03, 4.64, 5.17, 5.65, 6.09, 6.49, 6.90, 7.27, 
-             7.57, 7.82, 8.06, 8.26, 8.44, 8.60, 8.72, 8.83, 8.92, 8.98, 9.03, 9.07, 9.09, 9.12, 9.14, 9.16, 9.17};
-    }
     double fall_speed(double rin) const override {
-        double rout;
-        if(rin<r[0]){
-            double k1 = 1.19e8;
-            rout = k1 * rin * rin;
-        }
-        else{
-            int idx = left_index_min_zero_max_smallerlast(r, rin);
-            rout = linear_interpolate(r[idx], v[idx], r[idx+1], v[idx+1], rin);
-        }
-        return std::min(rout, 10.);
+        const UniformFallSpeedTable& t = uniform_fall_speed_table;
+        double x = rin * (1. / uniform_fall_speed_dr);
+        // truncating is the floor for positive radii, clamping the index
+        // instead of x keeps the batch version free of branches
+        int i = std::min(std::max(int(x), 0), uniform_fall_speed_n - 1);
+        double f = x - i;
+        return std::min(t.c0[i] + f * (t.c1[i] + f * t.c2[i]), 10.);
     }
-    private:
-    std::vector<double> r;
-    std::vector<double> v;
+    /// written for the loop vectorizer, see sedimentation.cpp
+    void fall_speed(const double* r, double* v, std::size_t n) const override;
 };
 
 class NoFallSpeed: public Sedimentation {
@@ -41,6 +95,9 @@ class NoFallSpeed: public Sedimentation {
     double fall_speed(double r) const override {
         return 0.;
     }
+    void fall_speed(const double* r, double* v, std::size_t n) const override {
+        std::fill(v, v + n, 0.);
+    }
 };
 
 inline std::unique_ptr<FallSpeedLU> mkFSLU(){
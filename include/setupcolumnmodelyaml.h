@@ -16,14 +16,41 @@
 #include "sedimentation.h"
 #include "constants.h"
 #include <exception>
+#include <fstream>
+#include <stdexcept>
+
+/** \brief input files a model reads on construction
+ *
+ * Models built from the same inputs share them, see loadModelInputs. Unset
+ * inputs are loaded by the model itself.
+ */
+struct ModelInputs {
+    std::shared_ptr<const std::vector<BackgroundLevelAfglus>> afglus;
+    std::shared_ptr<const NsData> ns;
+};
+
+/// loads the afglus profile, and the n(s) table if the twomey source is used
+inline ModelInputs loadModelInputs(const YAML::Node& config) {
+    ModelInputs inputs;
+    inputs.afglus = std::make_shared<const std::vector<BackgroundLevelAfglus>>(
+        read_afglus(config["radiation"]["data_path"].as<std::string>()));
+    if (config["particle_source"]["type"].as<std::string>() == "twomey") {
+        inputs.ns = std::make_shared<const NsData>(load_ns_data());
+    }
+    return inputs;
+}
 
 template <typename OIt, typename G>
 std::unique_ptr<SuperParticleSource<OIt>> createParticleSource(
-    G& gen, const Grid& grid, const YAML::Node& config) {
+    G& gen, const Grid& grid, const YAML::Node& config,
+    const NsData* ns = nullptr) {
     std::string type = config["type"].as<std::string>();
     int N_sp = config["N_sp"].as<int>();
     unsigned int N_lay = grid.n_lay;
-    if (type == "twomey") {
+    if (type == "twomey" && ns) {
+        return std::make_unique<Twomey<OIt, G>>(gen, N_sp, N_lay, *ns);
+    }
+    else if (type == "twomey") {
         return std::make_unique<Twomey<OIt, G>>(gen, N_sp, N_lay);
     } 
     else if (type == "no") {
@@ -34,7 +61,7 @@ std::unique_ptr<SuperParticleSource<OIt>> createParticleSource(
     }
 }
 
-void setQvProfile(double base, double roof, State& state) {
+inline void setQvProfile(double base, double roof, State& state) {
     int b_index = std::floor(base / state.grid.length) - 1;
     int r_index = std::floor(roof / state.grid.length) - 1;
 
@@ -53,7 +80,7 @@ void setQvProfile(double base, double roof, State& state) {
     }
 }
 
-State createState(const Grid& grid, const YAML::Node& config) {
+inline State createState(const Grid& grid, const YAML::Node& config) {
     double Theta0 = config["Theta0"].as<double>();
     double ALR = config["ALR"].as<double>();
     double p0 = config["p0"].as<double>();
@@ -85,14 +112,19 @@ State createState(const Grid& grid, const YAML::Node& config) {
     return state;
 }
 
-RadiationSolver createRadiationSolver(const YAML::Node& config) {
+inline RadiationSolver createRadiationSolver(
+    const YAML::Node& config,
+    const std::vector<BackgroundLevelAfglus>* afglus = nullptr) {
     bool sw = config["sw"].as<bool>();
     bool lw = config["lw"].as<bool>();
+    if (afglus) {
+        return RadiationSolver(*afglus, sw, lw);
+    }
     std::string data_path = config["data_path"].as<std::string>();
     return RadiationSolver(data_path, sw, lw);
 }
 
-std::unique_ptr<Advect> createAdvectionSolver(const YAML::Node& config) {
+inline std::unique_ptr<Advect> createAdvectionSolver(const YAML::Node& config) {
     std::string type = config["type"].as<std::string>();
     if (type == "advectandset"){
         double lifetime = config["lifetime"].as<double>();
@@ -126,7 +158,7 @@ std::unique_ptr<Advect> createAdvectionSolver(const YAML::Node& config) {
     }
 }
 
-std::unique_ptr<Grid> createGrid(const YAML::Node& config) {
+inline std::unique_ptr<Grid> createGrid(const YAML::Node& config) {
     double toa = config["toa"].as<double>();
     double gridlength = config["gridlength"].as<double>();
     return std::make_unique<Grid>(toa, gridlength);
@@ -141,10 +173,35 @@ std::unique_ptr<FluctuationSolver> createFluctuationSolver(
     return mkFS(gen, type, epsilon, l, grid);
 }
 
-std::unique_ptr<Collisions> createCollisionSolver(const Sedimentation& sedi,const YAML::Node& config){
+template <typename G>
+std::unique_ptr<Collisions> createCollisionSolver(G& gen, const Sedimentation& sedi,const YAML::Node& config, ThreadPool& pool){
     std::string type = config["type"].as<std::string>();
+    double skip_below = 0.;
+    if (config["skip_below"]) {
+        skip_below = config["skip_below"].as<double>();
+    }
+    unsigned int box_layers = 1;
+    std::size_t box_particles = 0;
+    if (config["box"] && config["box"]["layers"]) {
+        box_layers = config["box"]["layers"].as<unsigned int>();
+    }
+    if (config["box"] && config["box"]["particles"]) {
+        box_particles = config["box"]["particles"].as<std::size_t>();
+    }
+    if (config["kernal_cache"] && (type == "hall" || type == "sdm")) {
+        double tolerance = config["kernal_cache"]["tolerance"].as<double>();
+        if (type == "hall") {
+            return mkCachedHCS(sedi, tolerance, skip_below, box_layers,
+                               box_particles);
+        }
+        return mkCachedSDM(sedi, gen(), tolerance);
+    }
     if ( type == "hall"){
-        return mkHCS(sedi);
+        return mkHCS(sedi, pool, skip_below, box_layers, box_particles);
+    }
+    else if (type == "sdm")
+    {
+        return mkSDM(sedi, gen());
     }
     else if (type == "no")
     {
@@ -155,7 +212,7 @@ std::unique_ptr<Collisions> createCollisionSolver(const Sedimentation& sedi,cons
     }
 }
 
-std::unique_ptr<Sedimentation> createSedimentationSolver(const YAML::Node& config){
+inline std::unique_ptr<Sedimentation> createSedimentationSolver(const YAML::Node& config){
     std::string type = config["type"].as<std::string>();
     if ( type == "lookup"){
         return mkFSLU();
@@ -169,25 +226,89 @@ std::unique_ptr<Sedimentation> createSedimentationSolver(const YAML::Node& confi
     }
 }
 
+/// returns true for the fused particle kernel, the phased one is the default
+inline bool createCondensationKernel(const YAML::Node& config){
+    if (!config){
+        return false;
+    }
+    std::string type = config.as<std::string>();
+    if ( type == "fused"){
+        return true;
+    }
+    else if (type == "phased")
+    {
+        return false;
+    }
+    else{
+        throw std::logic_error("the type of the condensation kernel: " + type + " is not found");
+    }
+}
+
+/// the euler scheme is the default
+inline GrowthScheme createGrowthScheme(const YAML::Node& config){
+    if (!config){
+        return GrowthScheme::euler;
+    }
+    std::string type = config.as<std::string>();
+    if ( type == "euler"){
+        return GrowthScheme::euler;
+    }
+    else if (type == "implicit")
+    {
+        return GrowthScheme::implicit;
+    }
+    else{
+        throw std::logic_error("the type of the growth scheme: " + type + " is not found");
+    }
+}
+
 template <typename G>
-ColumnModel createColumnModel(G& gen, const YAML::Node& config) {
+ColumnModel createColumnModel(G& gen, const YAML::Node& config,
+                              const ModelInputs& inputs = {}) {
     double t_max = config["t_max"].as<double>();
     double dt = config["dt"].as<double>();
+    unsigned int threads =
+        config["threads"] ? config["threads"].as<unsigned int>() : 1;
+    bool fused = createCondensationKernel(config["kernel"]);
+    GrowthScheme growth = createGrowthScheme(config["growth"]);
+    double compaction_threshold =
+        config["compaction_threshold"]
+            ? config["compaction_threshold"].as<double>()
+            : 0.25;
 
     auto grid = createGrid(config["grid"]);
 
     auto advection_solver = createAdvectionSolver(config["advection"]);
     auto state = createState(*grid, config["initial_state"]);
-    auto radiation_solver = createRadiationSolver(config["radiation"]);
+    auto radiation_solver = createRadiationSolver(config["radiation"], inputs.afglus.get());
     auto source = createParticleSource<ColumnModel::OIt>(
-        gen, *grid, config["particle_source"]);
+        gen, *grid, config["particle_source"], inputs.ns.get());
     auto fluctuations =
         createFluctuationSolver(gen, config["fluctuations"], *grid);
     auto sedimentation = createSedimentationSolver(config["sedimentation"]);
-    auto collision_solver = createCollisionSolver(*sedimentation, config["collisions"]);
+    // one pool for the condensation and the collisions, which run in turn
+    auto pool = std::make_unique<ThreadPool>(threads);
+    auto collision_solver = createCollisionSolver(gen, *sedimentation, config["collisions"], *pool);
 
-    return ColumnModel(state, std::move(source), t_max, dt, radiation_solver,
-                       std::move(grid), std::move(advection_solver),
-                       std::move(fluctuations), std::move(collision_solver),
-                       std::move(sedimentation));
+    ColumnModel model(state, std::move(source), t_max, dt, radiation_solver,
+                      std::move(grid), std::move(advection_solver),
+                      std::move(fluctuations), std::move(collision_solver),
+                      std::move(sedimentation), std::move(pool), fused,
+                      compaction_threshold, growth);
+    if (config["checkpoint"]) {
+        model.checkpoint_every(config["checkpoint"]["interval"].as<double>(),
+                               config["checkpoint"]["file"].as<std::string>());
+    }
+    if (config["restart"]) {
+        std::string restart = config["restart"].as<std::string>();
+        std::ifstream is(restart, std::ios::binary);
+        if (!is) {
+            throw std::runtime_error("can't open the restart file: " + restart);
+        }
+        model.load_checkpoint(is);
+    }
+    if (config["profile"]) {
+        model.profile_to(config["profile"].as<std::string>());
+    }
+    return model;
 }
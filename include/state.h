@@ -1,6 +1,9 @@
 #pragma once
+#include <algorithm>
 #include <cmath>
 #include <memory>
+#include <stdexcept>
+#include "checkpoint.h"
 #include "linearfield.h"
 #include "layer_quantities.h"
 #include "level_quantities.h"
@@ -14,22 +17,63 @@ struct State {
     double cloud_base;
     double w_init;
     double qr_ground = 0;
+    /// read buffer holding the layers as they were at the last freeze()
+    std::vector<Layer> frozen_layers;
+
+    inline int layer_index(double z) const {
+        return std::floor(z / grid.length);
+    }
 
     inline Layer& layer_at(double z) {
-        int index = std::floor(z / grid.length);
-        return layers[index];
+        return layers[layer_index(z)];
+    }
+
+    /// copies the layers into the read buffer, reusing its storage
+    inline void freeze() {
+        frozen_layers.resize(layers.size());
+        std::copy(layers.begin(), layers.end(), frozen_layers.begin());
+    }
+
+    inline const Layer& frozen_layer_at(double z) const {
+        return frozen_layers[layer_index(z)];
     }
 
     inline void change_layer(double z, const Layer&& tendencies){
         Layer& l = layer_at(z);
         l += tendencies;
     }
-    inline const Level& lower_level_at(double z) {
+    inline const Level& lower_level_at(double z) const {
         int index = std::floor(z / grid.length);
         return levels[index];
     }
-    inline const Level& upper_level_at(double z) {
+    inline const Level& upper_level_at(double z) const {
         int index = std::ceil(z / grid.length);
         return levels[index];
     }
+
+    /// everything but the grid and the frozen layers, which are refilled by
+    /// the next freeze()
+    void save(CheckpointWriter& w) const {
+        w.section("STAT");
+        w.write(t);
+        w.write(layers);
+        w.write(levels);
+        w.write(cloud_base);
+        w.write(w_init);
+        w.write(qr_ground);
+    }
+
+    void load(CheckpointReader& r) {
+        r.section("STAT");
+        r.read(t);
+        r.read(layers);
+        r.read(levels);
+        r.read(cloud_base);
+        r.read(w_init);
+        r.read(qr_ground);
+        if (layers.size() != grid.n_lay || levels.size() != grid.n_lvl) {
+            throw std::runtime_error(
+                "the checkpoint does not match the configuration: grid");
+        }
+    }
 };
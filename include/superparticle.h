@@ -1,7 +1,26 @@
 #pragma once
+#include <cstdint>
 #include <ostream>
+#include "diagnostics.h"
 #include "thermodynamic.h"
 
+inline bool nucleation(double qc, double z, int N, double r) {
+    if (qc <= 0) {
+        return false;
+    }
+    if (z <= 0) {
+        report(Diagnostic::particle_reached_ground, r);
+        return false;
+    }
+    if (N <= 0) {
+        return false;
+    }
+    return true;
+}
+
+template <bool Const>
+class BasicSuperparticleRef;
+
 class Superparticle {
    public:
     Superparticle() = default;
@@ -24,28 +43,21 @@ class Superparticle {
     double v = 0;
     double S_prime = 0;
     double w_prime = 0;
+    /// key of the random stream of the particle, SuperparticleStore hands
+    /// out a new one on every insertion
+    std::uint64_t id = 0;
     inline double radius() const { return _radius; }
     void update() {
         _radius = ::radius(qc, N, r_dry, 1.);
-        is_nucleated = nucleation();
+        is_nucleated = ::nucleation(qc, z, N, _radius);
     }
 
    private:
     double _radius = 0;
-    bool nucleation() {
-        if (qc <= 0) {
-            return false;
-        }
-        if (z <= 0) {
-            std::cout << "particle reached the ground, r:" << radius()
-                      << std::endl;
-            return false;
-        }
-        if (N <= 0) {
-            return false;
-        }
-        return true;
-    }
+
+    template <bool>
+    friend class BasicSuperparticleRef;
+    friend class SuperparticleStore;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Superparticle& rhs) {
@@ -1,5 +1,8 @@
 #pragma once
+#include "cell_index.h"
+#include "checkpoint.h"
 #include "superparticle.h"
+#include "superparticle_store.h"
 #include "logger.h"
 
 template <typename OutputIterator>
@@ -7,8 +10,12 @@ class SuperParticleSource {
    public:
     virtual ~SuperParticleSource() {}
     virtual void init(Logger& logger){}
+    /// state that has to survive a restart, see checkpoint.h
+    virtual void save(CheckpointWriter& w) const {}
+    virtual void load(CheckpointReader& r) {}
     virtual void generateParticles(OutputIterator it, State& state, double dt,
-                                   const std::vector<Superparticle>& sp) = 0;
+                                   const SuperparticleStore& sp,
+                                   const CellIndex& cells) = 0;
 };
 
 template <typename D, typename G, typename OutputIterator>
@@ -19,13 +26,24 @@ class SuperParticleSourceConstHeight
                                    G g)
         : z_insert(z_insert), rate(rate), N(N), d(d), g(g){};
     void generateParticles(OutputIterator it, State& state,
-                           double dt, const std::vector<Superparticle>& sp) override {
+                           double dt, const SuperparticleStore& sp,
+                           const CellIndex& cells) override {
         for (int i = 0; i < dt * rate; ++i) {
             *it = Superparticle{0, z_insert, d(g), N, false};
             ++it;
         }
     }
 
+    void save(CheckpointWriter& w) const override {
+        w.write_streamed(d);
+        w.write_streamed(g);
+    }
+
+    void load(CheckpointReader& r) override {
+        r.read_streamed(d);
+        r.read_streamed(g);
+    }
+
    private:
     double z_insert;
     double rate;
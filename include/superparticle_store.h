@@ -0,0 +1,511 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "aligned_column.h"
+#include "checkpoint.h"
+#include "radius_kernel.h"
+#include "superparticle.h"
+#include "thermodynamic.h"
+
+/** \brief reference to one superparticle inside a SuperparticleStore
+ *
+ * Exposes the fields under the same names as Superparticle, so templated code
+ * (e.g. analize_sp.h or BoxCollisions) works on both layouts. Copying a
+ * reference copies the binding, not the values.
+ */
+template <bool Const>
+class BasicSuperparticleRef {
+    template <typename T>
+    using field = typename std::conditional<Const, const T&, T&>::type;
+    typedef typename std::conditional<Const, const Superparticle&,
+                                      Superparticle&>::type SpRef;
+
+   public:
+    BasicSuperparticleRef(field<double> qc, field<double> z,
+                          field<double> r_dry, field<int> N,
+                          field<bool> is_nucleated, field<double> v,
+                          field<double> S_prime, field<double> w_prime,
+                          field<double> radius, field<std::uint64_t> id)
+        : qc(qc),
+          z(z),
+          r_dry(r_dry),
+          N(N),
+          is_nucleated(is_nucleated),
+          v(v),
+          S_prime(S_prime),
+          w_prime(w_prime),
+          id(id),
+          _radius(radius) {}
+
+    BasicSuperparticleRef(SpRef sp)
+        : BasicSuperparticleRef(sp.qc, sp.z, sp.r_dry, sp.N, sp.is_nucleated,
+                                sp.v, sp.S_prime, sp.w_prime, sp._radius,
+                                sp.id) {}
+
+    template <bool C, typename = std::enable_if_t<Const && !C>>
+    BasicSuperparticleRef(const BasicSuperparticleRef<C>& other)
+        : BasicSuperparticleRef(other.qc, other.z, other.r_dry, other.N,
+                                other.is_nucleated, other.v, other.S_prime,
+                                other.w_prime, other._radius, other.id) {}
+
+    template <bool C = Const, typename = std::enable_if_t<!C>>
+    const BasicSuperparticleRef& operator=(const Superparticle& sp) const {
+        qc = sp.qc;
+        z = sp.z;
+        r_dry = sp.r_dry;
+        N = sp.N;
+        is_nucleated = sp.is_nucleated;
+        v = sp.v;
+        S_prime = sp.S_prime;
+        w_prime = sp.w_prime;
+        id = sp.id;
+        _radius = sp._radius;
+        return *this;
+    }
+
+    field<double> qc;
+    field<double> z;
+    field<double> r_dry;
+    field<int> N;
+    field<bool> is_nucleated;
+    field<double> v;
+    field<double> S_prime;
+    field<double> w_prime;
+    field<std::uint64_t> id;
+
+    inline double radius() const { return _radius; }
+
+    template <bool C = Const, typename = std::enable_if_t<!C>>
+    void update() const {
+        _radius = ::radius(qc, N, r_dry, 1.);
+        is_nucleated = ::nucleation(qc, z, N, _radius);
+    }
+
+    operator Superparticle() const {
+        Superparticle sp;
+        sp.qc = qc;
+        sp.z = z;
+        sp.r_dry = r_dry;
+        sp.N = N;
+        sp.is_nucleated = is_nucleated;
+        sp.v = v;
+        sp.S_prime = S_prime;
+        sp.w_prime = w_prime;
+        sp.id = id;
+        sp._radius = _radius;
+        return sp;
+    }
+
+   private:
+    field<double> _radius;
+
+    template <bool>
+    friend class BasicSuperparticleRef;
+};
+
+typedef BasicSuperparticleRef<false> SuperparticleRef;
+typedef BasicSuperparticleRef<true> SuperparticleCRef;
+
+template <bool Const>
+inline std::ostream& operator<<(std::ostream& os,
+                                const BasicSuperparticleRef<Const>& rhs) {
+    return os << Superparticle(rhs);
+}
+
+class SuperparticleStore;
+
+/** \brief random access iterator over a SuperparticleStore
+ *
+ * Dereferencing yields a BasicSuperparticleRef by value, so the iterator is a
+ * proxy iterator: it works with the non mutating standard algorithms, but
+ * not with std::sort (use sort_by_z or SuperparticleStore::permute).
+ */
+template <bool Const>
+class BasicSuperparticleIterator {
+    typedef typename std::conditional<Const, const SuperparticleStore,
+                                      SuperparticleStore>::type StoreT;
+
+   public:
+    typedef std::ptrdiff_t difference_type;
+    typedef Superparticle value_type;
+    typedef BasicSuperparticleRef<Const> reference;
+    struct pointer {
+        reference ref;
+        const reference* operator->() const { return &ref; }
+    };
+    typedef std::random_access_iterator_tag iterator_category;
+
+    BasicSuperparticleIterator() = default;
+    BasicSuperparticleIterator(StoreT* store, std::size_t i)
+        : store(store), i(i) {}
+    template <bool C, typename = std::enable_if_t<Const && !C>>
+    BasicSuperparticleIterator(const BasicSuperparticleIterator<C>& other)
+        : store(other.store), i(other.i) {}
+
+    reference operator*() const { return (*store)[i]; }
+    pointer operator->() const { return {**this}; }
+    reference operator[](difference_type n) const { return (*store)[i + n]; }
+
+    BasicSuperparticleIterator& operator++() {
+        ++i;
+        return *this;
+    }
+    BasicSuperparticleIterator operator++(int) {
+        auto that = *this;
+        ++i;
+        return that;
+    }
+    BasicSuperparticleIterator& operator--() {
+        --i;
+        return *this;
+    }
+    BasicSuperparticleIterator operator--(int) {
+        auto that = *this;
+        --i;
+        return that;
+    }
+    BasicSuperparticleIterator& operator+=(difference_type n) {
+        i += n;
+        return *this;
+    }
+    BasicSuperparticleIterator& operator-=(difference_type n) {
+        i -= n;
+        return *this;
+    }
+    BasicSuperparticleIterator operator+(difference_type n) const {
+        return {store, i + n};
+    }
+    friend BasicSuperparticleIterator operator+(
+        difference_type n, const BasicSuperparticleIterator& rhs) {
+        return rhs + n;
+    }
+    BasicSuperparticleIterator operator-(difference_type n) const {
+        return {store, i - n};
+    }
+    difference_type operator-(const BasicSuperparticleIterator& other) const {
+        return difference_type(i) - difference_type(other.i);
+    }
+    bool operator==(const BasicSuperparticleIterator& other) const {
+        return i == other.i;
+    }
+    bool operator!=(const BasicSuperparticleIterator& other) const {
+        return i != other.i;
+    }
+    bool operator<(const BasicSuperparticleIterator& other) const {
+        return i < other.i;
+    }
+    bool operator<=(const BasicSuperparticleIterator& other) const {
+        return i <= other.i;
+    }
+    bool operator>(const BasicSuperparticleIterator& other) const {
+        return i > other.i;
+    }
+    bool operator>=(const BasicSuperparticleIterator& other) const {
+        return i >= other.i;
+    }
+
+    std::size_t index() const { return i; }
+
+   private:
+    StoreT* store = nullptr;
+    std::size_t i = 0;
+
+    template <bool>
+    friend class BasicSuperparticleIterator;
+};
+
+/** \brief structure of arrays container for superparticles
+ *
+ * Every field lives in its own aligned, contiguous column, so a phase that
+ * only needs z, radius and N does not drag qc, v, S_prime, ... through the
+ * cache. Single particles are accessed through SuperparticleRef, which keeps
+ * the member names of Superparticle.
+ *
+ * Unnucleated particles are tombstones: they stay in their slot and are
+ * skipped by the kernels. collect_dead() files their slots for reuse by
+ * insert(), remove_unnucleated() compacts the columns.
+ *
+ * Every inserted particle gets a new id, which moves with the particle when
+ * the store is compacted or permuted.
+ */
+class SuperparticleStore {
+   public:
+    typedef Superparticle value_type;
+    typedef SuperparticleRef reference;
+    typedef SuperparticleCRef const_reference;
+    typedef BasicSuperparticleIterator<false> iterator;
+    typedef BasicSuperparticleIterator<true> const_iterator;
+    typedef std::size_t size_type;
+
+    SuperparticleStore() = default;
+    explicit SuperparticleStore(size_type n) { resize(n); }
+
+    size_type size() const { return qc.size(); }
+    bool empty() const { return qc.empty(); }
+
+    void reserve(size_type n) {
+        for_each_column([n](auto& c) { c.reserve(n); });
+    }
+    void resize(size_type n) {
+        if (n < size()) {
+            invalidate();
+        }
+        size_type old = size();
+        for_each_column([n](auto& c) { c.resize(n); });
+        for (size_type i = old; i < n; ++i) {
+            id[i] = next_id++;
+        }
+    }
+    void clear() {
+        invalidate();
+        for_each_column([](auto& c) { c.clear(); });
+    }
+
+    /// changes whenever indices of existing particles are invalidated
+    size_type generation() const { return gen; }
+
+    void push_back(const Superparticle& sp) {
+        qc.push_back(sp.qc);
+        z.push_back(sp.z);
+        r_dry.push_back(sp.r_dry);
+        N.push_back(sp.N);
+        is_nucleated.push_back(sp.is_nucleated);
+        v.push_back(sp.v);
+        S_prime.push_back(sp.S_prime);
+        w_prime.push_back(sp.w_prime);
+        radius.push_back(sp._radius);
+        id.push_back(next_id++);
+    }
+
+    /// stores sp in a slot filed by collect_dead, or appends it
+    void insert(const Superparticle& sp) {
+        if (free_slots.empty()) {
+            push_back(sp);
+            return;
+        }
+        (*this)[free_slots.back()] = sp;
+        id[free_slots.back()] = next_id++;
+        free_slots.pop_back();
+    }
+
+    /// files the slots of all unnucleated particles for reuse by insert
+    size_type collect_dead() {
+        free_slots.clear();
+        for (size_type i = size(); i-- > 0;) {
+            if (!is_nucleated[i]) {
+                free_slots.push_back(i);
+            }
+        }
+        return free_slots.size();
+    }
+
+    /// number of dead slots filed by the last collect_dead and not reused
+    size_type n_dead() const { return free_slots.size(); }
+    size_type n_live() const { return size() - n_dead(); }
+
+    reference operator[](size_type i) {
+        return {qc[i],      z[i], r_dry[i],   N[i],     is_nucleated[i],
+                v[i],       S_prime[i],       w_prime[i], radius[i], id[i]};
+    }
+    const_reference operator[](size_type i) const {
+        return {qc[i],      z[i], r_dry[i],   N[i],     is_nucleated[i],
+                v[i],       S_prime[i],       w_prime[i], radius[i], id[i]};
+    }
+
+    iterator begin() { return {this, 0}; }
+    iterator end() { return {this, size()}; }
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, size()}; }
+
+    /// refreshes the cached radius and the nucleation flag of particle i
+    void update(size_type i) {
+        radius[i] = ::radius(qc[i], N[i], r_dry[i], 1.);
+        is_nucleated[i] = ::nucleation(qc[i], z[i], N[i], radius[i]);
+    }
+
+    /// refreshes radius and nucleation flag of the particles in [begin, end)
+    /// with the batch radius kernel, dead particles stay dead
+    void update_radii(size_type begin, size_type end) {
+        batch_radius(qc.data() + begin, N.data() + begin, r_dry.data() + begin,
+                     radius.data() + begin, end - begin, 1.);
+        for (size_type i = begin; i < end; ++i) {
+            is_nucleated[i] = is_nucleated[i] &&
+                              ::nucleation(qc[i], z[i], N[i], radius[i]);
+        }
+    }
+
+    /// reorders the particles, such that new[k] = old[order[k]]
+    void permute(const std::vector<size_type>& order) {
+        invalidate();
+        gather(qc, scratch_d, order);
+        gather(z, scratch_d, order);
+        gather(r_dry, scratch_d, order);
+        gather(N, scratch_i, order);
+        gather(is_nucleated, scratch_b, order);
+        gather(v, scratch_d, order);
+        gather(S_prime, scratch_d, order);
+        gather(w_prime, scratch_d, order);
+        gather(radius, scratch_d, order);
+        gather(id, scratch_u, order);
+    }
+
+    /// removes all particles with is_nucleated == false, keeps the order
+    size_type remove_unnucleated() {
+        size_type n = size();
+        size_type j = 0;
+        for (size_type i = 0; i < size(); ++i) {
+            if (is_nucleated[i]) {
+                if (i != j) {
+                    move_slot(i, j);
+                }
+                ++j;
+            }
+        }
+        resize(j);
+        return n - j;
+    }
+
+    /// all columns and the bookkeeping of ids, dead slots and generation
+    void save(CheckpointWriter& w) const {
+        w.section("SPS ");
+        for_each_column([&w](const auto& c) { w.write(c); });
+        w.write(std::uint64_t(gen));
+        w.write(next_id);
+        w.write(free_slots);
+    }
+
+    void load(CheckpointReader& r) {
+        r.section("SPS ");
+        for_each_column([&r](auto& c) { r.read(c); });
+        for_each_column([this](const auto& c) {
+            if (c.size() != qc.size()) {
+                throw std::runtime_error(
+                    "the superparticle columns of the checkpoint differ in "
+                    "length");
+            }
+        });
+        std::uint64_t g;
+        r.read(g);
+        gen = g;
+        r.read(next_id);
+        r.read(free_slots);
+    }
+
+    AlignedColumn<double> qc;
+    AlignedColumn<double> z;
+    AlignedColumn<double> r_dry;
+    AlignedColumn<int> N;
+    AlignedColumn<bool> is_nucleated;
+    AlignedColumn<double> v;
+    AlignedColumn<double> S_prime;
+    AlignedColumn<double> w_prime;
+    AlignedColumn<double> radius;
+    AlignedColumn<std::uint64_t> id;
+
+   private:
+    void invalidate() {
+        ++gen;
+        free_slots.clear();
+    }
+
+    template <typename F>
+    void for_each_column(F f) {
+        f(qc);
+        f(z);
+        f(r_dry);
+        f(N);
+        f(is_nucleated);
+        f(v);
+        f(S_prime);
+        f(w_prime);
+        f(radius);
+        f(id);
+    }
+    template <typename F>
+    void for_each_column(F f) const {
+        f(qc);
+        f(z);
+        f(r_dry);
+        f(N);
+        f(is_nucleated);
+        f(v);
+        f(S_prime);
+        f(w_prime);
+        f(radius);
+        f(id);
+    }
+
+    void move_slot(size_type from, size_type to) {
+        qc[to] = qc[from];
+        z[to] = z[from];
+        r_dry[to] = r_dry[from];
+        N[to] = N[from];
+        is_nucleated[to] = is_nucleated[from];
+        v[to] = v[from];
+        S_prime[to] = S_prime[from];
+        w_prime[to] = w_prime[from];
+        radius[to] = radius[from];
+        id[to] = id[from];
+    }
+
+    template <typename T>
+    static void gather(AlignedColumn<T>& c, AlignedColumn<T>& scratch,
+                       const std::vector<size_type>& order) {
+        scratch.resize(order.size());
+        for (size_type k = 0; k < order.size(); ++k) {
+            scratch[k] = c[order[k]];
+        }
+        c.swap(scratch);
+    }
+
+    size_type gen = 0;
+    std::uint64_t next_id = 0;
+    std::vector<size_type> free_slots;
+    AlignedColumn<double> scratch_d;
+    AlignedColumn<int> scratch_i;
+    AlignedColumn<bool> scratch_b;
+    AlignedColumn<std::uint64_t> scratch_u;
+};
+
+/// output iterator that stores particles with SuperparticleStore::insert
+class SlotInsertIterator {
+   public:
+    typedef std::output_iterator_tag iterator_category;
+    typedef void value_type;
+    typedef void difference_type;
+    typedef void pointer;
+    typedef void reference;
+
+    explicit SlotInsertIterator(SuperparticleStore& sps) : sps(&sps) {}
+    SlotInsertIterator& operator=(const Superparticle& sp) {
+        sps->insert(sp);
+        return *this;
+    }
+    SlotInsertIterator& operator*() { return *this; }
+    SlotInsertIterator& operator++() { return *this; }
+    SlotInsertIterator operator++(int) { return *this; }
+
+   private:
+    SuperparticleStore* sps;
+};
+
+inline SlotInsertIterator slot_inserter(SuperparticleStore& sps) {
+    return SlotInsertIterator(sps);
+}
+
+inline void sort_by_z(SuperparticleStore& sps) {
+    std::vector<std::size_t> order(sps.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&sps](std::size_t a, std::size_t b) {
+                  return sps.z[a] < sps.z[b];
+              });
+    sps.permute(order);
+}
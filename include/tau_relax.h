@@ -1,7 +1,8 @@
 #pragma once
 #include <vector>
+#include "cell_index.h"
 #include "grid.h"
-#include "superparticle.h"
+#include "superparticle_store.h"
 
 class TauRelax {
    public:
@@ -9,7 +10,7 @@ class TauRelax {
         : grid(grid) {
     }
 
-    void refresh(const std::vector<Superparticle>& sp);
+    void refresh(const SuperparticleStore& sp, const CellIndex& cells);
     inline double operator()(double z) const;
 
    private:
@@ -23,8 +23,17 @@ double critical_saturation(double r_dry, double T);
  */
 bool will_nucleate(double r_dry, double S, double T);
 
+/** \brief integrators of the diffusional growth
+ *
+ * euler: explicit step in r, needs dt well below the growth time scale of
+ * the smallest droplets. implicit: trapezoidal step in r^2, exact for E = 0
+ * and stable for any dt, see implicit_condensation_solver.
+ */
+enum class GrowthScheme { euler, implicit };
+
 Tendencies condensation(double qc, double N, const double r_dry, double S, double T,
-                        double E, double dt);
+                        double E, double dt,
+                        GrowthScheme scheme = GrowthScheme::euler);
 
 double radius(double qc, double N, double r_min = 0., double rho = RHO_AIR);
 
@@ -35,6 +44,11 @@ double saturation_pressure(const double T);
 double condensation_solver(const double r_old, const double es, const double T,
                            const double S, const double E, const double dt);
 
+/// new radius after dt, never negative, 0 if the droplet evaporates
+double implicit_condensation_solver(const double r_old, const double es,
+                                    const double T, const double S,
+                                    const double E, const double dt);
+
 double diffusional_growth(const double r_old, const double es, const double T,
                           const double S, const double E, const double dt);
 
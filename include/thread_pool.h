@@ -0,0 +1,118 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "diagnostics.h"
+
+/** \brief fixed set of worker threads that is reused for every step
+ *
+ * run(n, f) calls f(task) for every task in [0, n) and returns when all of
+ * them are finished. The calling thread works on the tasks as well, so a pool
+ * of size one does not start any thread. The first exception thrown by a task
+ * is rethrown by run. The workers report to the diagnostic channel of the
+ * caller of run.
+ */
+class ThreadPool {
+   public:
+    explicit ThreadPool(unsigned int n_threads) {
+        for (unsigned int i = 1; i < n_threads; ++i) {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stop = true;
+        }
+        start.notify_all();
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+
+    unsigned int size() const { return workers.size() + 1; }
+
+    template <typename F>
+    void run(std::size_t n_tasks, F f) {
+        if (workers.empty()) {
+            for (std::size_t i = 0; i < n_tasks; ++i) {
+                f(i);
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m);
+            task = [](void* f, std::size_t i) { (*static_cast<F*>(f))(i); };
+            context = &f;
+            channel = &diagnostics();
+            n = n_tasks;
+            next = 0;
+            pending = workers.size();
+            error = nullptr;
+            ++round;
+        }
+        start.notify_all();
+        execute();
+        std::unique_lock<std::mutex> lock(m);
+        done.wait(lock, [this] { return pending == 0; });
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+   private:
+    void execute() {
+        for (std::size_t i = next++; i < n; i = next++) {
+            try {
+                task(context, i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(m);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    void work() {
+        std::size_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m);
+                start.wait(lock, [&] { return stop || round != seen; });
+                if (stop) {
+                    return;
+                }
+                seen = round;
+            }
+            {
+                DiagnosticScope scope(*channel);
+                execute();
+            }
+            std::lock_guard<std::mutex> lock(m);
+            if (--pending == 0) {
+                done.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex m;
+    std::condition_variable start;
+    std::condition_variable done;
+    bool stop = false;
+    std::size_t round = 0;
+    std::size_t pending = 0;
+    void (*task)(void*, std::size_t) = nullptr;
+    void* context = nullptr;
+    DiagnosticChannel* channel = nullptr;
+    std::size_t n = 0;
+    std::atomic<std::size_t> next{0};
+    std::exception_ptr error;
+};
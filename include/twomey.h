@@ -5,6 +5,7 @@
 #include <memory>
 #include <random>
 #include <cassert>
+#include "analize_sp.h"
 #include "analize_state.h"
 #include "grid.h"
 #include "member_iterator.h"
@@ -60,14 +61,42 @@ class Twomey : public SuperParticleSource<OIt> {
         Stab = nstable(N_sp, N_multi);
     };
 
+    /// takes the n(s) table from data instead of loading it
+    Twomey(G& gen, int N_sp, int N_lay, const NsData& data)
+        : N_multi(0),
+          N_sp(N_sp),
+          nprf_cmp(N_lay, 0),
+          Stab(N_sp, 0.),
+          gen(gen) {
+        Stab = nstable(data, N_sp, N_multi);
+    };
+
     void init(Logger& logger) {
         logger.setAttr("N_sp", N_sp);
         logger.setAttr("N_multi", N_multi);
     }
 
+    /// saves the generator as well, which the model shares with the source
+    void save(CheckpointWriter& w) const override {
+        w.write(N_sp);
+        w.write(N_multi);
+        w.write(nprf_cmp);
+        w.write(Stab);
+        w.write_streamed(gen);
+    }
+
+    void load(CheckpointReader& r) override {
+        r.expect(N_sp, "N_sp");
+        r.read(N_multi);
+        r.read(nprf_cmp);
+        r.read(Stab);
+        r.read_streamed(gen);
+    }
+
     void generateParticles(OIt sp_itr, State& state, double dt,
-                           const std::vector<Superparticle>& sp) {
-        std::vector<int> nucprf = count_nucleated_ccn(sp, state.grid);
+                           const SuperparticleStore& sp,
+                           const CellIndex& cells) {
+        std::vector<int> nucprf = count_nucleated_ccn(sp, cells);
         std::vector<double> Sprf = supersaturation_profile(state);
         std::vector<int> nprf = indexes(Stab, Sprf);
         std::transform(nprf.begin(), nprf.end(), nprf.begin(), [this](int x){return x * this->N_multi;});
@@ -130,7 +159,8 @@ class NoParticleSource : public SuperParticleSource<OIt> {
     }
 
     void generateParticles(OIt sp_itr, State& state, double dt,
-                           const std::vector<Superparticle>& sp) {}
+                           const SuperparticleStore& sp,
+                           const CellIndex& cells) {}
 
    private:
     const int N_multi;
@@ -0,0 +1,167 @@
+#pragma once
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "cell_index.h"
+#include "state.h"
+#include "superparticle_store.h"
+#include "thermodynamic.h"
+
+/** \brief validation levels of the step loop
+ *
+ * off: no checks at all. cheap: per particle checks inside the kernels and
+ * the O(number of layers) invariants of the state on every step. audit: in
+ * addition a full audit of state, superparticles and cell index on every
+ * COLUMNMODEL_AUDIT_INTERVAL-th step.
+ *
+ * The level is fixed at compile time by COLUMNMODEL_VALIDATION (0, 1 or 2,
+ * see the VALIDATION cmake option). Without it, builds with NDEBUG validate
+ * nothing and all other builds audit every step.
+ */
+enum class Validation { off = 0, cheap = 1, audit = 2 };
+
+#ifndef COLUMNMODEL_VALIDATION
+#ifdef NDEBUG
+#define COLUMNMODEL_VALIDATION 0
+#else
+#define COLUMNMODEL_VALIDATION 2
+#endif
+#endif
+
+#ifndef COLUMNMODEL_AUDIT_INTERVAL
+#define COLUMNMODEL_AUDIT_INTERVAL 1
+#endif
+
+template <typename Sp>
+void check_sp(const Sp& sp) {
+    if (sp.qc < 0.) {
+        throw std::logic_error("qc of one superparticle is smaller zero: " +
+                               std::to_string(sp.qc));
+    }
+    if (sp.N < 0.) {
+        throw std::logic_error("N of one superparticle is smaller zero: " +
+                               std::to_string(sp.N));
+    }
+}
+
+inline void check_state(const State& state) {
+    for (const auto& l : state.layers) {
+        if (l.qv < 0) {
+            std::cout << "index qv" << std::endl;
+            for (unsigned int i = 0; i < state.layers.size(); ++i) {
+                std::cout << i << " " << state.layers[i].qv << std::endl;
+            }
+            throw std::logic_error("qv is smaller then zero ");
+        }
+    }
+}
+
+inline void audit_state(const State& state) {
+    check_state(state);
+    for (unsigned int i = 0; i < state.layers.size(); ++i) {
+        const Layer& l = state.layers[i];
+        if (!std::isfinite(l.T) || !std::isfinite(l.p) ||
+            !std::isfinite(l.qv) || !std::isfinite(l.E)) {
+            throw std::logic_error("layer " + std::to_string(i) +
+                                   " holds a non finite value");
+        }
+    }
+}
+
+/// checks every nucleated superparticle, dead slots are skipped
+inline void audit_superparticles(const SuperparticleStore& sps,
+                                 const Grid& grid) {
+    for (size_t i = 0; i < sps.size(); ++i) {
+        if (!sps.is_nucleated[i]) {
+            continue;
+        }
+        check_sp(sps[i]);
+        if (!(sps.z[i] >= 0. && sps.z[i] <= grid.height)) {
+            throw std::logic_error("superparticle " + std::to_string(i) +
+                                   " left the column: z=" +
+                                   std::to_string(sps.z[i]));
+        }
+        double r = radius(sps.qc[i], sps.N[i], sps.r_dry[i], 1.);
+        if (!(std::abs(sps.radius[i] - r) <= 1.e-12 * r)) {
+            throw std::logic_error("cached radius of superparticle " +
+                                   std::to_string(i) + " is stale: " +
+                                   std::to_string(sps.radius[i]) + " vs " +
+                                   std::to_string(r));
+        }
+    }
+}
+
+/// checks that every nucleated particle is filed under its layer, and only
+/// those
+inline void audit_cells(const SuperparticleStore& sps, const CellIndex& cells,
+                        const Grid& grid) {
+    size_t filed = 0;
+    for (size_t l = 0; l < cells.size(); ++l) {
+        filed += cells[l].size();
+    }
+    size_t live = 0;
+    for (size_t i = 0; i < sps.size(); ++i) {
+        int expected = -1;
+        if (sps.is_nucleated[i]) {
+            expected = grid.getlayindex(sps.z[i]);
+            ++live;
+        }
+        if (cells.cell_of(i) != expected) {
+            throw std::logic_error(
+                "superparticle " + std::to_string(i) + " is filed under " +
+                std::to_string(cells.cell_of(i)) + " instead of layer " +
+                std::to_string(expected));
+        }
+    }
+    if (filed != live) {
+        throw std::logic_error("the cell index lists " +
+                               std::to_string(filed) + " particles, but " +
+                               std::to_string(live) + " are nucleated");
+    }
+}
+
+/// validation policy of ColumnModel::step, see Validation
+template <Validation Level, int AuditInterval = 1>
+struct StepValidator {
+    static constexpr bool cheap = Level >= Validation::cheap;
+    static constexpr bool audit = Level >= Validation::audit;
+
+    static bool audit_step(int step) {
+        return audit && step % AuditInterval == 0;
+    }
+
+    /// per particle checks inside the kernels
+    template <typename Sp>
+    static void particle(const Sp& sp) {
+        if (cheap) {
+            check_sp(sp);
+        }
+    }
+
+    /// after new particles were generated, before they condense
+    static void before_condensation(int step, const State& state,
+                                    const SuperparticleStore& sps) {
+        if (cheap) {
+            check_state(state);
+        }
+        if (audit_step(step)) {
+            audit_superparticles(sps, state.grid);
+        }
+    }
+
+    /// at the end of the step, after the cell index is updated
+    static void after_step(int step, const State& state,
+                           const SuperparticleStore& sps,
+                           const CellIndex& cells) {
+        if (audit_step(step)) {
+            audit_state(state);
+            audit_superparticles(sps, state.grid);
+            audit_cells(sps, cells, state.grid);
+        }
+    }
+};
+
+typedef StepValidator<static_cast<Validation>(COLUMNMODEL_VALIDATION),
+                      COLUMNMODEL_AUDIT_INTERVAL>
+    Validator;
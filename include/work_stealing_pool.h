@@ -0,0 +1,153 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** \brief thread pool for independent, long running tasks of uneven length
+ *
+ * Every worker owns a task deque. submit() deals the tasks round robin (or
+ * onto the own deque when called from a worker), a worker takes its newest
+ * task first and, once its deque is empty, steals the oldest task of the
+ * other workers. wait() blocks until every submitted task finished and
+ * rethrows the first exception a task threw.
+ */
+class WorkStealingPool {
+   public:
+    typedef std::function<void()> Task;
+
+    explicit WorkStealingPool(unsigned int n_threads) {
+        if (n_threads == 0) {
+            n_threads = 1;
+        }
+        for (unsigned int i = 0; i < n_threads; ++i) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        for (unsigned int i = 0; i < n_threads; ++i) {
+            workers.emplace_back([this, i] { work(i); });
+        }
+    }
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stop = true;
+        }
+        wake.notify_all();
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+
+    unsigned int size() const { return workers.size(); }
+
+    void submit(Task task) {
+        const Worker& w = current();
+        size_t q = w.pool == this ? w.index : next_queue++ % size();
+        // counted before it is visible to the workers, a thief must not
+        // finish the task before it is pending
+        {
+            std::lock_guard<std::mutex> lock(m);
+            ++queued;
+            ++pending;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queues[q]->m);
+            queues[q]->tasks.push_back(std::move(task));
+        }
+        wake.notify_one();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(m);
+        done.wait(lock, [this] { return pending == 0; });
+        if (error) {
+            auto e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+   private:
+    /// the pool and queue of the calling thread, if it is a worker
+    struct Worker {
+        const WorkStealingPool* pool;
+        size_t index;
+    };
+    static Worker& current() {
+        static thread_local Worker w{nullptr, 0};
+        return w;
+    }
+
+    struct Queue {
+        std::mutex m;
+        std::deque<Task> tasks;
+    };
+
+    bool pop(size_t i, Task& task) {
+        {
+            std::lock_guard<std::mutex> lock(queues[i]->m);
+            if (!queues[i]->tasks.empty()) {
+                task = std::move(queues[i]->tasks.back());
+                queues[i]->tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < queues.size(); ++k) {
+            auto& q = *queues[(i + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.m);
+            if (!q.tasks.empty()) {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(size_t i) {
+        current() = Worker{this, i};
+        while (true) {
+            Task task;
+            if (pop(i, task)) {
+                --queued;
+                try {
+                    task();
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(m);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+                std::lock_guard<std::mutex> lock(m);
+                if (--pending == 0) {
+                    done.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m);
+            wake.wait(lock, [this] { return stop || queued > 0; });
+            if (stop && queued == 0) {
+                return;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex m;
+    std::condition_variable wake;
+    std::condition_variable done;
+    bool stop = false;
+    std::atomic<size_t> queued{0};
+    size_t pending = 0;
+    std::atomic<size_t> next_queue{0};
+    std::exception_ptr error;
+};
@@ -0,0 +1,58 @@
+#include "cell_index.h"
+
+void CellIndex::update(const SuperparticleStore& sps) {
+    if (sps.generation() != generation) {
+        rebuild(sps);
+        return;
+    }
+    cell.resize(sps.size(), -1);
+    slot.resize(sps.size(), 0);
+    for (size_t i = 0; i < sps.size(); ++i) {
+        int c = layer_of(sps, i);
+        if (c != cell[i]) {
+            if (cell[i] >= 0) {
+                remove(i);
+            }
+            if (c >= 0) {
+                insert(i, c);
+            }
+        }
+    }
+}
+
+void CellIndex::rebuild(const SuperparticleStore& sps) {
+    for (auto& c : cells) {
+        c.clear();
+    }
+    generation = sps.generation();
+    cell.assign(sps.size(), -1);
+    slot.resize(sps.size());
+    for (size_t i = 0; i < sps.size(); ++i) {
+        int c = layer_of(sps, i);
+        if (c >= 0) {
+            insert(i, c);
+        }
+    }
+}
+
+void CellIndex::insert(size_t i, int c) {
+    slot[i] = cells[c].size();
+    cells[c].push_back(i);
+    cell[i] = c;
+}
+
+void CellIndex::remove(size_t i) {
+    auto& c = cells[cell[i]];
+    size_t last = c.back();
+    c[slot[i]] = last;
+    slot[last] = slot[i];
+    c.pop_back();
+    cell[i] = -1;
+}
+
+int CellIndex::layer_of(const SuperparticleStore& sps, size_t i) const {
+    if (!sps.is_nucleated[i]) {
+        return -1;
+    }
+    return grid.getlayindex(sps.z[i]);
+}
@@ -0,0 +1,93 @@
+#include "collision.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define COLUMNMODEL_X86_DISPATCH 1
+#define COLUMNMODEL_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define COLUMNMODEL_X86_DISPATCH 0
+#define COLUMNMODEL_ALWAYS_INLINE inline
+#endif
+
+namespace {
+typedef void (*HallRow)(const Efficiencies&, double, double, const double*,
+                        const double*, double*, std::size_t);
+
+/// in blocks on the stack, which can't alias the table of the efficiencies,
+/// so that the compiler vectorizes the loop without checks. Inlined into the
+/// versions for every instruction set
+COLUMNMODEL_ALWAYS_INLINE void hall_row(const Efficiencies& efficiencies,
+                                        double r, double fs, const double* R,
+                                        const double* fs_R, double* out,
+                                        std::size_t n) {
+    const std::size_t block_size = 64;
+    double block[block_size];
+    for (std::size_t first = 0; first < n; first += block_size) {
+        std::size_t m = std::min(block_size, n - first);
+        const double* R_b = R + first;
+        const double* fs_b = fs_R + first;
+        for (std::size_t j = 0; j < m; ++j) {
+            block[j] = PI * (R_b[j] + r) * (R_b[j] + r) *
+                       std::abs(fs - fs_b[j]) *
+                       efficiencies.collision_efficiency_branchless(
+                           R_b[j] * 1.e6, r / R_b[j]);
+        }
+        std::copy(block, block + m, out + first);
+    }
+}
+
+void hall_row_default(const Efficiencies& efficiencies, double r, double fs,
+                      const double* R, const double* fs_R, double* out,
+                      std::size_t n) {
+    hall_row(efficiencies, r, fs, R, fs_R, out, n);
+}
+
+#if COLUMNMODEL_X86_DISPATCH
+__attribute__((target("avx2"))) void hall_row_avx2(
+    const Efficiencies& efficiencies, double r, double fs, const double* R,
+    const double* fs_R, double* out, std::size_t n) {
+    hall_row(efficiencies, r, fs, R, fs_R, out, n);
+}
+
+__attribute__((target("avx512f"))) void hall_row_avx512(
+    const Efficiencies& efficiencies, double r, double fs, const double* R,
+    const double* fs_R, double* out, std::size_t n) {
+    hall_row(efficiencies, r, fs, R, fs_R, out, n);
+}
+#endif
+
+struct HallRowVersion {
+    HallRow row;
+    const char* isa;
+};
+
+HallRowVersion select_hall_row() {
+#if COLUMNMODEL_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return {hall_row_avx512, "avx512"};
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return {hall_row_avx2, "avx2"};
+    }
+#endif
+    return {hall_row_default, "default"};
+}
+
+const HallRowVersion hall_row_version = select_hall_row();
+}  // namespace
+
+void kernal_row(const HallCollisionKernal<Efficiencies>& kernal, double r,
+                double fs, const double* R, const double* fs_R, double* out,
+                std::size_t n) {
+    for (std::size_t j = 0; j < n; ++j) {
+        if (R[j] <= 0.) {
+            report(Diagnostic::nonpositive_collision_radius, R[j]);
+        }
+    }
+    hall_row_version.row(kernal.collision_efficiencies(), r, fs, R, fs_R, out,
+                         n);
+}
+
+const char* kernal_row_isa() { return hall_row_version.isa; }
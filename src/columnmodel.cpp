@@ -1,10 +1,14 @@
 #include "columnmodel.h"
+#include <cmath>
+#include <cstdio>
 #include <cstdlib>
 #include <exception>
+#include <fstream>
 #include <iostream>
 #include <iterator>
 #include <random>
 #include "analize_sp.h"
+#include "checkpoint.h"
 #include "collision.h"
 #include "continuouse_state_view.h"
 #include "logger.h"
@@ -12,6 +16,7 @@
 #include "saturation_fluctuations.h"
 #include "thermodynamic.h"
 #include "twomey.h"
+#include "validation.h"
 
 void cooling_the_column(State& state, double dt) {
     std::vector<double> cooling(state.grid.n_lay, -2.3e-5 * 24. * dt);
@@ -22,18 +27,6 @@ void cooling_the_column(State& state, double dt) {
                    [](double x, double y) { return x + y; });
 }
 
-void check_state(State& state) {
-    for (auto l : state.layers) {
-        if (l.qv < 0) {
-            std::cout << "index qv" << std::endl;
-            for (unsigned int i = 0; i < state.layers.size(); ++i) {
-                std::cout << i << " " << state.layers[i].qv << std::endl;
-            }
-            throw std::logic_error("qv is smaller then zero ");
-        }
-    }
-}
-
 void check_S(const State& s, const State& os) {
     for (unsigned int i = 0; i > s.layers.size(); ++i) {
         Layer lay = s.layers[i];
@@ -50,145 +43,193 @@ void check_S(const State& s, const State& os) {
     }
 }
 
-void check_sp(const Superparticle& sp) {
-    if (sp.qc < 0.) {
-        throw std::logic_error("qc of one superparticle is smaller zero: " +
-                               std::to_string(sp.qc));
+void ColumnModel::run(std::shared_ptr<Logger> logger) {
+    // the logger drains the events of this model only
+    DiagnosticScope scope(*channel);
+    logger->initialize(state, dt);
+    radiation_solver.init(*logger);
+    source->init(*logger);
+
+    logger->log(state, superparticles, cells);
+    while (is_running()) {
+        step();
+        {
+            StepProfiler::Scope timer(profiler, Phase::logging);
+            log_every_seconds(logger, 30.);
+        }
+        if (checkpoint_steps > 0 && runs % checkpoint_steps == 0) {
+            StepProfiler::Scope timer(profiler, Phase::checkpoint);
+            write_checkpoint();
+        }
+        profiler.end_step(superparticles, cells);
     }
-    if (sp.N < 0.) {
-        throw std::logic_error("N of one superparticle is smaller zero: " +
-                               std::to_string(sp.N));
+    if (!profile_target.empty()) {
+        write_profile();
     }
 }
 
-void check_superparticles(const std::vector<Superparticle>& sp,
-                          const Grid& grid) {
-    for (auto s : sp) {
-        check_sp(s);
+void ColumnModel::profile_to(const std::string& target) {
+    profile_target = target;
+}
+
+void ColumnModel::write_profile() const {
+    ProfileCounters counters = collisions->counters();
+    if (profile_target == "stdout") {
+        profiler.report(std::cout, counters);
+        return;
+    }
+    std::ofstream os(profile_target);
+    profiler.report(os, counters);
+    if (!os) {
+        throw std::runtime_error("can't write the profile: " +
+                                 profile_target);
     }
 }
 
-void ColumnModel::run(std::shared_ptr<Logger> logger) {
-    logger->initialize(state, dt);
-    radiation_solver.init(*logger);
-    source->init(*logger);
+void ColumnModel::save_checkpoint(std::ostream& os) const {
+    CheckpointWriter w(os);
+    w.section("MODL");
+    w.write(dt);
+    w.write(runs);
+    state.save(w);
+    superparticles.save(w);
+    cells.save(w);
+    radiation_solver.save(w);
+    w.section("SRC ");
+    source->save(w);
+    w.section("FLUC");
+    fluctuations->save(w);
+    w.section("COLL");
+    collisions->save(w);
+    w.section("END ");
+}
 
-    logger->log(state, superparticles);
-    while (is_running()) {
-        step();
-        log_every_seconds(logger, 30.);
+void ColumnModel::load_checkpoint(std::istream& is) {
+    CheckpointReader r(is);
+    r.section("MODL");
+    r.expect(dt, "dt");
+    r.read(runs);
+    state.load(r);
+    superparticles.load(r);
+    cells.load(r);
+    radiation_solver.load(r);
+    r.section("SRC ");
+    source->load(r);
+    r.section("FLUC");
+    fluctuations->load(r);
+    r.section("COLL");
+    collisions->load(r);
+    r.section("END ");
+}
+
+void ColumnModel::checkpoint_every(double interval, const std::string& file) {
+    checkpoint_steps = std::max(1l, std::lround(interval / dt));
+    checkpoint_file = file;
+}
+
+void ColumnModel::write_checkpoint() const {
+    std::string tmp = checkpoint_file + ".tmp";
+    std::ofstream os(tmp, std::ios::binary);
+    save_checkpoint(os);
+    os.close();
+    if (!os || std::rename(tmp.c_str(), checkpoint_file.c_str()) != 0) {
+        throw std::runtime_error("can't write the checkpoint: " +
+                                 checkpoint_file);
     }
 }
 
 void ColumnModel::step() {
-    advection_solver->advect(state, dt);
-    advection_solver->setupdraft(state, runs * dt);
-    advection_solver->keepcloudbase(state);
-
-    fluctuations->refresh(superparticles);
-
-    State old_state(state);
-
-    source->generateParticles(std::back_inserter(superparticles), state, dt,
-                              superparticles);
-
-    if (true) {
-        check_state(state);
-        check_superparticles(superparticles, state.grid);
-    }
-    do_condensation(old_state);
-    removeUnnucleated(superparticles);
-    for (const auto& sp : superparticles) {
-        assert(sp.is_nucleated == true);
-        assert(sp.qc >= 0);
-        assert(sp.z >= 0);
-        assert(sp.N >= 0);
-    }
-    do_collisions();
-    removeUnnucleated(superparticles);
-    radiation_solver.calculate_radiation(state, superparticles);
-}
-
-void ColumnModel::do_condensation(State& old_state) {
-    for (auto& sp : superparticles) {
-        Layer lay = old_state.layer_at(sp.z);
-        Level lvl = old_state.upper_level_at(sp.z);
-        double S = super_saturation(lay.T, lay.p, lay.qv) +
-                   fluctuations->getFluctuation(sp, dt);
-        if (sp.is_nucleated) {
-            auto tendencies = calc_tendencies(sp, S, lay.T, lay.E, dt);
-            apply_tendencies_to_superparticle(sp, tendencies, lvl);
-            apply_tendencies_to_state(sp, tendencies);
-        }
+    {
+        StepProfiler::Scope timer(profiler, Phase::advection);
+        advection_solver->advect(state, dt);
+        advection_solver->setupdraft(state, runs * dt);
+        advection_solver->keepcloudbase(state);
+    }
+    {
+        StepProfiler::Scope timer(profiler, Phase::fluctuations);
+        fluctuations->refresh(superparticles, cells);
     }
+
+    state.freeze();
+
+    {
+        StepProfiler::Scope timer(profiler, Phase::generation);
+        source->generateParticles(slot_inserter(superparticles), state, dt,
+                                  superparticles, cells);
+    }
+    {
+        StepProfiler::Scope timer(profiler, Phase::validation);
+        Validator::before_condensation(runs, state, superparticles);
+    }
+    {
+        StepProfiler::Scope timer(profiler, Phase::condensation);
+        do_condensation();
+    }
+    {
+        StepProfiler::Scope timer(profiler, Phase::collisions);
+        do_collisions();
+    }
+    profiler.count(collisions->step_counters());
+    {
+        StepProfiler::Scope timer(profiler, Phase::bookkeeping);
+        retire_dead();
+        cells.update(superparticles);
+    }
+    {
+        StepProfiler::Scope timer(profiler, Phase::validation);
+        Validator::after_step(runs, state, superparticles, cells);
+    }
+    {
+        StepProfiler::Scope timer(profiler, Phase::radiation);
+        radiation_solver.calculate_radiation(state, superparticles, cells);
+    }
+}
+
+void ColumnModel::do_condensation() {
+    condensation.condense(state, superparticles, *fluctuations, dt);
 }
 
 void ColumnModel::do_collisions() {
-    if (collisions->needs_sorted_superparticles()) {
-        std::sort(superparticles.begin(), superparticles.end(),
-                  [](const auto& a, const auto& b) { return a.z < b.z; });
-    }
-    auto collision_tendencies =
-        collisions->collide(superparticles, state.grid, dt);
-    for (const auto& c : collision_tendencies) {
-        if (std::isnan(c.dqc)) {
-            throw std::logic_error("collison dqc is nan");
-        }
-    }
+    cells.update(superparticles);
+    collisions->collide(superparticles, cells, dt, collision_tendencies);
     apply_collision_tendencies(superparticles, collision_tendencies);
 }
 
 void ColumnModel::apply_collision_tendencies(
-    std::vector<Superparticle>& sps,
+    SuperparticleStore& sps,
     const std::vector<SpMassTendencies>& tendencies) {
+    if (tendencies.empty()) {
+        return;
+    }
     assert(sps.size() == tendencies.size());
     for (size_t i = 0; i < sps.size(); ++i) {
-        sps[i].N += tendencies[i].dN;
-        sps[i].qc += tendencies[i].dqc;
-        sps[i].update();
-    }
-}
-
-void ColumnModel::log_every_seconds(std::shared_ptr<Logger> logger,
-                                    double dt_out) {
-    if (!std::abs(std::remainder(runs * dt, dt_out))) {
-        logger->log(state, superparticles);
+        if (!sps.is_nucleated[i]) {
+            continue;
+        }
+        if (std::isnan(tendencies[i].dqc)) {
+            throw std::logic_error("collison dqc is nan");
+        }
+        sps.N[i] += tendencies[i].dN;
+        sps.qc[i] += tendencies[i].dqc;
     }
+    sps.update_radii(0, sps.size());
 }
 
-void ColumnModel::apply_tendencies_to_superparticle(Superparticle& sp,
-                                                    Tendencies& tendencies,
-                                                    const Level& lvl) {
-    sp.v = lvl.w - sedimentation->fall_speed(sp.radius());
-    double cfl = sp.v * dt / state.grid.length;
-    if (cfl > 1) {
-        throw std::logic_error("the cfl criteria is broken: cfl=" +
-                               std::to_string(cfl));
+void ColumnModel::retire_dead() {
+    superparticles.collect_dead();
+    if (superparticles.n_dead() >
+        compaction_threshold * superparticles.size()) {
+        removeUnnucleated(superparticles);
     }
-    sp.z += dt * sp.v;
-    sp.qc += tendencies.dqc;
-    sp.update();
-    check_sp(sp);
 }
 
-void ColumnModel::apply_tendencies_to_state(const Superparticle& sp,
-                                            const Tendencies& tendencies) {
-    if (sp.z >= 0) {
-        state.change_layer(sp.z, {0, 0, -tendencies.dqc, 0});
-    }
-    if (sp.z <= 0. && sp.qc > 0 && sp.N > 0) {
-        state.qr_ground += sp.qc;
+void ColumnModel::log_every_seconds(std::shared_ptr<Logger> logger,
+                                    double dt_out) {
+    if (!std::abs(std::remainder(runs * dt, dt_out))) {
+        logger->log(state, superparticles, cells);
     }
 }
 
-Tendencies ColumnModel::calc_tendencies(const Superparticle& superparticle,
-                                        const double S, const double T,
-                                        const double E, const double dt) {
-    auto tendencies = condensation(superparticle.qc, superparticle.N,
-                                   superparticle.r_dry, S, T, E, dt);
-    return tendencies;
-}
-
 bool ColumnModel::is_running() {
     runs++;
     state.t = runs * dt;
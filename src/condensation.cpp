@@ -0,0 +1,127 @@
+#include "condensation.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include "thermodynamic.h"
+
+void Condensation::condense(State& state, SuperparticleStore& sps,
+                            FluctuationSolver& fluctuations, double dt) {
+    size_t n_chunks = pool.size();
+    if (!fused) {
+        fluctuation.resize(sps.size());
+        auto draw = [&](size_t c) {
+            size_t begin = c * sps.size() / n_chunks;
+            size_t end = (c + 1) * sps.size() / n_chunks;
+            for (size_t i = begin; i < end; ++i) {
+                if (sps.is_nucleated[i]) {
+                    fluctuation[i] = fluctuations.getFluctuation(sps[i], dt);
+                }
+            }
+        };
+        if (fluctuations.is_thread_safe()) {
+            pool.run(n_chunks, draw);
+        } else {
+            for (size_t c = 0; c < n_chunks; ++c) {
+                draw(c);
+            }
+        }
+    }
+
+    size_t n_lay = state.layers.size();
+    // pad every chunk buffer to whole cache lines
+    size_t stride = (n_lay + 7) / 8 * 8;
+    dqv.assign(n_chunks * stride, 0.);
+    qr_ground.assign(n_chunks, 0.);
+
+    auto chunk = [&](size_t c) {
+        size_t begin = c * sps.size() / n_chunks;
+        size_t end = (c + 1) * sps.size() / n_chunks;
+        if (fused) {
+            fused_chunk(state, sps, fluctuations, begin, end,
+                        &dqv[c * stride], qr_ground[c], dt);
+        } else {
+            condense_chunk(state, sps, begin, end, &dqv[c * stride],
+                           qr_ground[c], dt);
+        }
+    };
+    if (fused && !fluctuations.is_thread_safe()) {
+        for (size_t c = 0; c < n_chunks; ++c) {
+            chunk(c);
+        }
+    } else {
+        pool.run(n_chunks, chunk);
+    }
+
+    for (size_t c = 0; c < n_chunks; ++c) {
+        for (size_t l = 0; l < n_lay; ++l) {
+            state.layers[l].qv += dqv[c * stride + l];
+        }
+        state.qr_ground += qr_ground[c];
+    }
+}
+
+void Condensation::condense_chunk(const State& state, SuperparticleStore& sps,
+                                  size_t begin, size_t end, double* dqv,
+                                  double& qr_ground, double dt) const {
+    for (size_t i = begin; i < end; ++i) {
+        auto sp = sps[i];
+        if (!sp.is_nucleated) {
+            continue;
+        }
+        const Layer& lay = state.frozen_layer_at(sp.z);
+        double S = super_saturation(lay.T, lay.p, lay.qv) + fluctuation[i];
+        condense_particle(state, sp, S, dqv, qr_ground, dt);
+    }
+    sps.update_radii(begin, end);
+}
+
+void Condensation::fused_chunk(const State& state, SuperparticleStore& sps,
+                               FluctuationSolver& fluctuations, size_t begin,
+                               size_t end, double* dqv, double& qr_ground,
+                               double dt) const {
+    for (size_t i = begin; i < end; ++i) {
+        auto sp = sps[i];
+        if (!sp.is_nucleated) {
+            continue;
+        }
+        Validator::particle(sp);
+        const Layer& lay = state.frozen_layer_at(sp.z);
+        double S = super_saturation(lay.T, lay.p, lay.qv) +
+                   fluctuations.getFluctuation(sp, dt);
+        condense_particle(state, sp, S, dqv, qr_ground, dt);
+        sps.update_radii(i, i + 1);
+    }
+}
+
+/// expects a nucleated particle, dead slots are skipped by the callers. The
+/// radius is refreshed by the callers, with SuperparticleStore::update_radii
+void Condensation::condense_particle(const State& state, SuperparticleRef sp,
+                                     double S, double* dqv, double& qr_ground,
+                                     double dt) const {
+    const Layer& lay = state.frozen_layer_at(sp.z);
+    const Level& lvl = state.upper_level_at(sp.z);
+    auto tendencies =
+        condensation(sp.qc, sp.N, sp.r_dry, S, lay.T, lay.E, dt, growth);
+    apply_tendencies_to_superparticle(sp, tendencies, lvl, state.grid.length,
+                                      dt);
+    if (sp.z >= 0) {
+        dqv[state.layer_index(sp.z)] -= tendencies.dqc;
+    }
+    if (sp.z <= 0. && sp.qc > 0 && sp.N > 0) {
+        qr_ground += sp.qc;
+    }
+}
+
+void Condensation::apply_tendencies_to_superparticle(
+    SuperparticleRef sp, const Tendencies& tendencies, const Level& lvl,
+    double length, double dt) const {
+    sp.v = lvl.w - sedimentation.fall_speed(sp.radius());
+    double cfl = sp.v * dt / length;
+    if (cfl > 1) {
+        throw std::logic_error("the cfl criteria is broken: cfl=" +
+                               std::to_string(cfl));
+    }
+    sp.z += dt * sp.v;
+    sp.qc += tendencies.dqc;
+    Validator::particle(sp);
+}
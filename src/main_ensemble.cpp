@@ -0,0 +1,37 @@
+#include <fstream>
+#include <iostream>
+#include <yaml-cpp/yaml.h>
+#include "ensemble.h"
+
+int main(int argc, char** argv) {
+    try {
+        YAML::Node config;
+        if (argc == 2) {
+            std::ifstream input(argv[1]);
+            config = YAML::Load(input);
+        } else {
+            config = YAML::Load(std::cin);
+        }
+        auto members = createEnsemble(config);
+        auto results = runEnsemble(config, members);
+        int failed = 0;
+        for (const auto& r : results) {
+            if (r.ok) {
+                std::cout << r.name << ": done" << std::endl;
+            } else {
+                std::cout << r.name << ": failed: " << r.error << std::endl;
+                ++failed;
+            }
+        }
+        return failed ? 1 : 0;
+    } catch (YAML::Exception e) {
+        std::cerr << "Error while parsing yaml file" << std::endl;
+        std::cerr << "Line: " << e.mark.line << " Col: " << e.mark.column
+                  << std::endl;
+        std::cerr << e.what() << std::endl;
+        throw e;
+    } catch (std::logic_error e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -2,7 +2,8 @@
 #include "yaml-cpp/yaml.h"
 #include "setupcolumnmodelyaml.h" 
 #include <vector>
-#include "superparticle.h"
+#include "cell_index.h"
+#include "superparticle_store.h"
 
 
 auto configdata = YAML::Load( R"FOO(
@@ -25,9 +26,11 @@ int main(){
     auto grid = createGrid(configdata["grid"]);
     auto state = createState(*grid, configdata["initial_state"]);
     logger->initialize(state, 0.1);
-    std::vector<Superparticle> sps(300);
+    SuperparticleStore sps(300);
+    CellIndex cells(*grid);
+    cells.update(sps);
     for (int i=0; i<30000; ++i)
     {
-        logger->log(state, sps);
+        logger->log(state, sps, cells);
     }
 }
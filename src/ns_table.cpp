@@ -23,10 +23,19 @@ std::vector<double> calculate_stable(const std::vector<double>& n, const std::ve
     return out;
 }
 
+NsData load_ns_data(){
+    NsData data;
+    load_data(data.n, data.s);
+    return data;
+}
+
 std::vector<double> nstable(int Nsp, int& Nmulti){
-    std::vector<double> n;
-    std::vector<double> s;
-    load_data(n, s);
+    return nstable(load_ns_data(), Nsp, Nmulti);
+}
+
+std::vector<double> nstable(const NsData& data, int Nsp, int& Nmulti){
+    const std::vector<double>& n = data.n;
+    const std::vector<double>& s = data.s;
     double maximum = *std::max_element(n.begin(), n.end());
     double step = maximum / double(Nsp);
     Nmulti = std::floor(step);
@@ -0,0 +1,23 @@
+#include "sedimentation.h"
+#include <algorithm>
+
+/// in blocks on the stack, which can't alias the table, so that the compiler
+/// vectorizes the loop without checks
+void FallSpeedLU::fall_speed(const double* r, double* v, std::size_t n) const {
+    const double* c0 = uniform_fall_speed_table.c0;
+    const double* c1 = uniform_fall_speed_table.c1;
+    const double* c2 = uniform_fall_speed_table.c2;
+    const std::size_t block_size = 64;
+    double block[block_size];
+    for (std::size_t first = 0; first < n; first += block_size) {
+        std::size_t m = std::min(block_size, n - first);
+        const double* r_b = r + first;
+        for (std::size_t j = 0; j < m; ++j) {
+            double x = r_b[j] * (1. / uniform_fall_speed_dr);
+            int i = std::min(std::max(int(x), 0), uniform_fall_speed_n - 1);
+            double f = x - i;
+            block[j] = std::min(c0[i] + f * (c1[i] + f * c2[i]), 10.);
+        }
+        std::copy(block, block + m, v + first);
+    }
+}
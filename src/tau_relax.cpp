@@ -2,13 +2,15 @@
 #include <algorithm>
 #include <limits>
 
-void TauRelax::refresh(const std::vector<Superparticle>& sp) {
+void TauRelax::refresh(const SuperparticleStore& sp,
+                       const CellIndex& cells) {
     tau_relax.resize(grid.n_lay);
     double a2 = 2.8e-4;
     std::vector<double> one_over_tau(grid.n_lay, 0.);
-    for (auto s : sp) {
-        int index = grid.getlayindex(s.z);
-        one_over_tau[index] += s.radius() * s.N;
+    for (size_t l = 0; l < cells.size(); ++l) {
+        for (auto i : cells[l]) {
+            one_over_tau[l] += sp.radius[i] * sp.N[i];
+        }
     }
     std::transform(one_over_tau.begin(), one_over_tau.end(), tau_relax.begin(),
     [a2](double x) {
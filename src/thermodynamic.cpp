@@ -1,5 +1,7 @@
 #include "thermodynamic.h"
+#include <algorithm>
 #include <vector>
+#include "diagnostics.h"
 #include "layer_quantities.h"
 #include "level_quantities.h"
 
@@ -29,12 +31,15 @@ double critical_saturation(double r_dry, double T) {
 }
 
 Tendencies condensation(double qc, double N, const double r_dry, double S, double T,
-                        double E, double dt) {
+                        double E, double dt, GrowthScheme scheme) {
     Tendencies tendencies{0, 0};
 
     const double r_old = radius(qc, N, r_dry);
     const double es = saturation_pressure(T);
-    const double r_new = condensation_solver(r_old, es, T, S, E, dt);
+    const double r_new =
+        scheme == GrowthScheme::implicit
+            ? implicit_condensation_solver(r_old, es, T, S, E, dt)
+            : condensation_solver(r_old, es, T, S, E, dt);
 
     if (r_new < r_dry){
         tendencies.dqc = -qc;
@@ -72,8 +77,35 @@ double condensation_solver(const double r_old, const double es, const double T,
     return r_old + dt * diffusional_growth(r_old, es, T, S, E, dt);
 }
 
+/// dr/dt = a / r + b
+static void growth_coefficients(const double es, const double T,
+                                const double S, const double E, double& a,
+                                double& b) {
+    auto c1 =
+        H_LAT * H_LAT / (R_V * K * T*T) + R_V * T / (D * es);
+    auto c2 = H_LAT / (R_V * K * T*T);
+    a = S / (c1 * RHO_H2O);
+    b = c2 * E / (c1 * RHO_H2O);
+}
+
+double implicit_condensation_solver(const double r_old, const double es,
+                                    const double T, const double S,
+                                    const double E, const double dt) {
+    // trapezoidal step of d(r^2)/dt = 2 a + 2 b r, the quadratic in r_new is
+    // solved exactly instead of with newton iterations
+    double a, b;
+    growth_coefficients(es, T, S, E, a, b);
+    double h = 0.5 * dt * b;
+    double d = h * h + r_old * r_old + 2. * dt * a + dt * b * r_old;
+    if (d <= 0.) {
+        return 0.;
+    }
+    return std::max(h + std::sqrt(d), 0.);
+}
+
 double diffusional_growth(const double r_old, const double es, const double T,
                           const double S, const double E, const double dt) {
+    // not written with growth_coefficients, which rounds differently
     auto c1 =
         H_LAT * H_LAT / (R_V * K * T*T) + R_V * T / (D * es);
     auto c2 = H_LAT / (R_V * K * T*T);
@@ -86,9 +118,7 @@ double fall_speed(const double r) {
     //    assert np.all(r >= 0)
     //    assert np.all(r < 2.e-3)
     if (r > 2.e-3) {
-        std::cout
-            << "large drops present, adjust droplet fall_speed function, r="
-            << r << std::endl;
+        report(Diagnostic::large_drop, r);
     }
 
     double k1 = 1.19e8;
@@ -0,0 +1,42 @@
+#include "alloc_counter.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global allocation functions of the test binary, and
+// posix_memalign of the AlignedColumns, so tests can assert that a code path
+// does not touch the heap.
+
+static std::atomic<std::size_t> n_alloc{0};
+
+std::size_t allocation_count() { return n_alloc.load(); }
+
+void* operator new(std::size_t size) {
+    ++n_alloc;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete[](void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+extern "C" int posix_memalign(void** p, std::size_t alignment,
+                              std::size_t size) noexcept {
+    ++n_alloc;
+    // aligned_alloc takes multiples of the alignment, std::free releases it
+    std::size_t rounded = (std::max<std::size_t>(size, 1) + alignment - 1) /
+                          alignment * alignment;
+    *p = aligned_alloc(alignment, rounded);
+    return *p ? 0 : ENOMEM;
+}
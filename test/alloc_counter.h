@@ -0,0 +1,5 @@
+#pragma once
+#include <cstddef>
+
+/// number of calls to the global operator new since program start
+std::size_t allocation_count();
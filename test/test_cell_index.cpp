@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <vector>
+#include "cell_index.h"
+#include "grid.h"
+#include "gtest/gtest.h"
+#include "superparticle_store.h"
+
+static std::vector<size_t> sorted(std::vector<size_t> v) {
+    std::sort(v.begin(), v.end());
+    return v;
+}
+
+TEST(cell_index, test_files_particles_by_layer) {
+    Grid grid{3., 1.};
+    SuperparticleStore sps;
+    sps.push_back({0.00001, 0.5, 1.e-6, int(1e8)});
+    sps.push_back({0.00001, 2.5, 1.e-6, int(1e8)});
+    sps.push_back({0.00001, 0.7, 1.e-6, int(1e8)});
+    CellIndex cells(grid);
+    cells.update(sps);
+    EXPECT_EQ(sorted(cells[0]), std::vector<size_t>({0, 2}));
+    EXPECT_TRUE(cells[1].empty());
+    EXPECT_EQ(cells[2], std::vector<size_t>({1}));
+}
+
+TEST(cell_index, test_moves_particles) {
+    Grid grid{3., 1.};
+    SuperparticleStore sps;
+    sps.push_back({0.00001, 0.5, 1.e-6, int(1e8)});
+    sps.push_back({0.00001, 0.6, 1.e-6, int(1e8)});
+    CellIndex cells(grid);
+    cells.update(sps);
+    sps.z[0] = 1.5;
+    sps.push_back({0.00001, 1.2, 1.e-6, int(1e8)});
+    cells.update(sps);
+    EXPECT_EQ(cells[0], std::vector<size_t>({1}));
+    EXPECT_EQ(sorted(cells[1]), std::vector<size_t>({0, 2}));
+    EXPECT_EQ(cells.cell_of(0), 1);
+}
+
+TEST(cell_index, test_skips_unnucleated_and_follows_compaction) {
+    Grid grid{3., 1.};
+    SuperparticleStore sps;
+    sps.push_back({0.00001, 0.5, 1.e-6, int(1e8)});
+    sps.push_back({0.00001, 1.5, 1.e-6, int(1e8)});
+    sps.push_back({0.00001, 2.5, 1.e-6, int(1e8)});
+    CellIndex cells(grid);
+    cells.update(sps);
+    sps.is_nucleated[0] = false;
+    cells.update(sps);
+    EXPECT_TRUE(cells[0].empty());
+    EXPECT_EQ(cells.cell_of(0), -1);
+    sps.remove_unnucleated();
+    cells.update(sps);
+    EXPECT_EQ(cells[1], std::vector<size_t>({0}));
+    EXPECT_EQ(cells[2], std::vector<size_t>({1}));
+}
+
+TEST(cell_index, test_reused_slots_stay_incremental) {
+    Grid grid{3., 1.};
+    SuperparticleStore sps;
+    sps.push_back({0.00001, 0.5, 1.e-6, int(1e8)});
+    sps.push_back({0.00001, 1.5, 1.e-6, int(1e8)});
+    CellIndex cells(grid);
+    cells.update(sps);
+    sps.is_nucleated[0] = false;
+    cells.update(sps);
+    EXPECT_TRUE(cells[0].empty());
+    sps.collect_dead();
+    sps.insert({0.00001, 2.5, 1.e-6, int(1e8)});
+    cells.update(sps);
+    EXPECT_EQ(cells[1], std::vector<size_t>({1}));
+    EXPECT_EQ(cells[2], std::vector<size_t>({0}));
+    EXPECT_EQ(cells.cell_of(0), 2);
+}
@@ -0,0 +1,184 @@
+#include <yaml-cpp/yaml.h>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include "checkpoint.h"
+#include "gtest/gtest.h"
+#include "setupcolumnmodelyaml.h"
+
+namespace {
+class NullLogger : public Logger {
+   public:
+    void log(const State& state, const SuperparticleStore& superparticles,
+             const CellIndex& cells) override {}
+};
+
+/// no data files: a made up afglus profile and n(s) table
+ModelInputs checkpoint_inputs() {
+    ModelInputs inputs;
+    inputs.afglus = std::make_shared<const std::vector<BackgroundLevelAfglus>>(
+        std::vector<BackgroundLevelAfglus>{
+            {0., 1013., 288., 2.5e19, 7.e11, 5.e18, 1.e17, 8.e15, 5.e8},
+            {1., 898., 282., 2.3e19, 7.e11, 4.8e18, 8.e16, 7.e15, 5.e8},
+            {2., 795., 275., 2.1e19, 7.e11, 4.4e18, 5.e16, 6.e15, 5.e8}});
+    inputs.ns = std::make_shared<const NsData>(
+        NsData{{0., 1.e7, 5.e7, 1.e8, 2.e8}, {0., 1.e-5, 1.e-4, 1.e-3, 1.e-2}});
+    return inputs;
+}
+
+YAML::Node checkpoint_config(double dt = 0.1,
+                             const std::string& collisions = "hall") {
+    YAML::Node config = YAML::Load(R"(
+t_max: 4.
+grid: {toa: 1000., gridlength: 20.}
+initial_state: {ALR: 0.004, Theta0: 297.2, p0: 100000., cloud_base: 300.,
+                cloud_roof: 400., w: 1.}
+radiation: {sw: false, lw: false, data_path: unused}
+particle_source: {type: twomey, N_sp: 50}
+fluctuations: {type: markov, epsilon: 50.e-4, l: 100.}
+collisions: {type: hall}
+sedimentation: {type: lookup}
+advection: {type: secondfirstorderupwind, lifetime: 3000.}
+)");
+    config["dt"] = dt;
+    config["collisions"]["type"] = collisions;
+    return config;
+}
+
+void expect_bit_for_bit_restart(const std::string& collisions) {
+    const std::string file =
+        ::testing::TempDir() + "checkpoint_test_" + collisions + ".bin";
+    auto inputs = checkpoint_inputs();
+    auto logger = std::make_shared<NullLogger>();
+
+    std::mt19937_64 gen_a(1);
+    auto a = createColumnModel(gen_a, checkpoint_config(0.1, collisions),
+                               inputs);
+    std::ostringstream start;
+    a.save_checkpoint(start);
+    a.checkpoint_every(2., file);
+    a.run(logger);
+    std::ostringstream end_a;
+    a.save_checkpoint(end_a);
+
+    // a different seed, everything random has to come from the checkpoint
+    std::mt19937_64 gen_b(2);
+    auto b = createColumnModel(gen_b, checkpoint_config(0.1, collisions),
+                               inputs);
+    {
+        std::ifstream is(file, std::ios::binary);
+        b.load_checkpoint(is);
+    }
+    std::remove(file.c_str());
+    b.run(logger);
+    std::ostringstream end_b;
+    b.save_checkpoint(end_b);
+
+    EXPECT_GT(end_a.str().size(), start.str().size());
+    EXPECT_TRUE(end_a.str() == end_b.str());
+}
+}  // namespace
+
+TEST(checkpoint, values_round_trip) {
+    std::stringstream ss;
+    {
+        CheckpointWriter w(ss);
+        w.section("TEST");
+        w.write(3.5);
+        w.write(std::vector<int>{1, 2, 3});
+        w.write(std::vector<std::vector<size_t>>{{1}, {}, {2, 3}});
+        w.write(std::string("text"));
+        std::mt19937_64 gen(7);
+        gen.discard(10);
+        w.write_streamed(gen);
+    }
+    CheckpointReader r(ss);
+    r.section("TEST");
+    double d;
+    std::vector<int> v;
+    std::vector<std::vector<size_t>> vv;
+    std::string s;
+    std::mt19937_64 gen(1);
+    r.read(d);
+    r.read(v);
+    r.read(vv);
+    r.read(s);
+    r.read_streamed(gen);
+    EXPECT_EQ(d, 3.5);
+    EXPECT_EQ(v, (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(vv, (std::vector<std::vector<size_t>>{{1}, {}, {2, 3}}));
+    EXPECT_EQ(s, "text");
+    std::mt19937_64 expected(7);
+    expected.discard(10);
+    EXPECT_EQ(gen, expected);
+}
+
+TEST(checkpoint, rejects_foreign_and_broken_streams) {
+    std::stringstream foreign("not a checkpoint at all");
+    EXPECT_THROW(CheckpointReader r(foreign), std::runtime_error);
+
+    std::stringstream ss;
+    {
+        CheckpointWriter w(ss);
+        w.section("TEST");
+        w.write(std::vector<double>(10, 1.));
+    }
+    std::string full = ss.str();
+    std::stringstream truncated(full.substr(0, full.size() - 8));
+    CheckpointReader r(truncated);
+    std::vector<double> v;
+    EXPECT_THROW(r.section("OTHR"), std::runtime_error);
+    EXPECT_THROW(r.read(v), std::runtime_error);
+
+    std::string future = full;
+    future[6] = char(checkpoint_version + 1);
+    std::stringstream newer(future);
+    EXPECT_THROW(CheckpointReader r(newer), std::runtime_error);
+}
+
+TEST(checkpoint, superparticle_store_round_trip) {
+    SuperparticleStore sps;
+    for (int i = 0; i < 5; ++i) {
+        sps.push_back({0.00001, i + 0.5, 1.e-6, int(1e8)});
+    }
+    sps.is_nucleated[2] = false;
+    sps.collect_dead();
+    std::stringstream ss;
+    {
+        CheckpointWriter w(ss);
+        sps.save(w);
+    }
+    SuperparticleStore loaded;
+    CheckpointReader r(ss);
+    loaded.load(r);
+    ASSERT_EQ(loaded.size(), 5u);
+    EXPECT_EQ(loaded.n_dead(), 1u);
+    EXPECT_EQ(loaded.generation(), sps.generation());
+    loaded.insert({0.00002, 10.5, 1.e-6, int(1e8)});
+    sps.insert({0.00002, 10.5, 1.e-6, int(1e8)});
+    for (size_t i = 0; i < sps.size(); ++i) {
+        EXPECT_EQ(loaded.z[i], sps.z[i]);
+        EXPECT_EQ(loaded.id[i], sps.id[i]);
+        EXPECT_EQ(loaded.is_nucleated[i], sps.is_nucleated[i]);
+    }
+}
+
+TEST(checkpoint, restart_continues_bit_for_bit) {
+    expect_bit_for_bit_restart("hall");
+}
+
+TEST(checkpoint, restart_continues_bit_for_bit_with_sdm_collisions) {
+    expect_bit_for_bit_restart("sdm");
+}
+
+TEST(checkpoint, restart_needs_the_same_configuration) {
+    auto inputs = checkpoint_inputs();
+    std::mt19937_64 gen(1);
+    auto a = createColumnModel(gen, checkpoint_config(0.1), inputs);
+    std::stringstream ss;
+    a.save_checkpoint(ss);
+    auto b = createColumnModel(gen, checkpoint_config(0.2), inputs);
+    EXPECT_THROW(b.load_checkpoint(ss), std::runtime_error);
+}
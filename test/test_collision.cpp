@@ -2,8 +2,15 @@
 #include "sedimentation.h"
 #include "efficiencies.h"
 #include "gtest/gtest.h"
+#include <cmath>
+#include <memory>
 #include <vector>
 #include "superparticle.h"
+#include "superparticle_store.h"
+#include "cell_index.h"
+#include "grid.h"
+#include "thermodynamic.h"
+#include "thread_pool.h"
 
 TEST(hall_collision_kernal, test_value){
     double r = 1.e-6;
@@ -70,3 +77,392 @@ TEST(collide, test_same_two_values){
 //    EXPECT_TRUE(out[0].dN <= 0);
 //    EXPECT_TRUE(out[2].dN == 0);
 //}
+
+namespace {
+/// one box of n particles with radii from 5 to 30 um
+SuperparticleStore sdm_box(size_t n, int N = 100000000) {
+    SuperparticleStore sps;
+    for (size_t i = 0; i < n; ++i) {
+        double r = 5.e-6 + 25.e-6 * i / n;
+        sps.push_back({cloud_water(N + int(i), r, 1.e-8, 1.), 50., 1.e-8,
+                       N + int(i)});
+    }
+    return sps;
+}
+}  // namespace
+
+TEST(sdm_collide, conserves_water_and_only_removes_droplets) {
+    Grid grid{100., 100.};
+    SuperparticleStore sps = sdm_box(101);
+    CellIndex cells(grid);
+    cells.update(sps);
+    FallSpeedLU sedi;
+    auto sdm = mkSDM(sedi, 1);
+    auto mt = sdm->collide(sps, cells, 100.);
+    double dqc = 0, qc = 0;
+    int coalesced = 0;
+    for (size_t i = 0; i < sps.size(); ++i) {
+        dqc += mt[i].dqc;
+        qc += sps.qc[i];
+        EXPECT_LE(mt[i].dN, 0);
+        EXPECT_GE(sps.N[i] + mt[i].dN, 0);
+        EXPECT_GE(sps.qc[i] + mt[i].dqc, 0);
+        coalesced += mt[i].dN < 0;
+    }
+    EXPECT_NEAR(dqc, 0, 1.e-14 * qc);
+    EXPECT_GT(coalesced, 0);
+}
+
+TEST(sdm_collide, depends_only_on_the_seed) {
+    Grid grid{100., 100.};
+    SuperparticleStore sps = sdm_box(64);
+    CellIndex cells(grid);
+    cells.update(sps);
+    FallSpeedLU sedi;
+    auto a = mkSDM(sedi, 3)->collide(sps, cells, 10.);
+    auto b = mkSDM(sedi, 3)->collide(sps, cells, 10.);
+    auto c = mkSDM(sedi, 4)->collide(sps, cells, 10.);
+    bool differs = false;
+    for (size_t i = 0; i < sps.size(); ++i) {
+        EXPECT_EQ(a[i].dN, b[i].dN);
+        EXPECT_EQ(a[i].dqc, b[i].dqc);
+        differs = differs || a[i].dN != c[i].dN;
+    }
+    EXPECT_TRUE(differs);
+}
+
+TEST(sdm_collide, single_droplets_merge_into_one) {
+    Grid grid{100., 100.};
+    SuperparticleStore sps;
+    sps.push_back({cloud_water(1, 10.e-6, 1.e-8, 1.), 50., 1.e-8, 1});
+    sps.push_back({cloud_water(1, 30.e-6, 1.e-8, 1.), 50., 1.e-8, 1});
+    CellIndex cells(grid);
+    cells.update(sps);
+    FallSpeedLU sedi;
+    // a probability above one, the pair always coalesces
+    auto mt = mkSDM(sedi, 1)->collide(sps, cells, 1.e12);
+    size_t gone = mt[0].dN < 0 ? 0 : 1;
+    size_t merged = 1 - gone;
+    EXPECT_EQ(mt[gone].dN, -1);
+    EXPECT_EQ(mt[gone].dqc, -sps.qc[gone]);
+    EXPECT_EQ(mt[merged].dN, 0);
+    EXPECT_DOUBLE_EQ(sps.qc[merged] + mt[merged].dqc, sps.qc[0] + sps.qc[1]);
+}
+
+TEST(sdm_collide, removes_droplets_at_the_mean_field_rate) {
+    Grid grid{100., 100.};
+    SuperparticleStore sps = sdm_box(50);
+    CellIndex cells(grid);
+    cells.update(sps);
+    FallSpeedLU sedi;
+    const double dt = 0.1;
+    double mean_field = 0;
+    for (const auto& t : mkHCS(sedi)->collide(sps, cells, dt)) {
+        mean_field += t.dN;
+    }
+    auto sdm = mkSDM(sedi, 5);
+    const int steps = 4000;
+    double monte_carlo = 0;
+    for (int s = 0; s < steps; ++s) {
+        for (const auto& t : sdm->collide(sps, cells, dt)) {
+            monte_carlo += t.dN;
+        }
+    }
+    EXPECT_LT(mean_field, 0);
+    EXPECT_NEAR(monte_carlo / steps, mean_field, 0.1 * std::abs(mean_field));
+}
+
+TEST(cached_kernal, interpolates_within_the_tolerance) {
+    HallCollisionKernal<Efficiencies> kernal({});
+    CachedCollisionKernal<HallCollisionKernal<Efficiencies>> cached(kernal,
+                                                                    1.e-3);
+    // the efficiencies are one, the kernal is smooth. The tolerance is
+    // relative to the largest value of a bin
+    for (int pass = 0; pass < 2; ++pass) {
+        for (double R = 150.e-6; R < 290.e-6; R *= 1.013) {
+            for (double r = 0.2 * R; r < R; r *= 1.029) {
+                double exact = kernal(r, R, 2.);
+                EXPECT_NEAR(cached(r, R, 2.), exact, 2.e-3 * exact);
+                EXPECT_EQ(cached(R, r, -2.), cached(r, R, 2.));
+            }
+        }
+    }
+    EXPECT_GT(cached.hits(), cached.misses());
+}
+
+TEST(cached_kernal, counts_hits_and_misses_of_all_copies) {
+    CachedCollisionKernal<HallCollisionKernal<Efficiencies>> cached({{}},
+                                                                    1.e-2);
+    auto copy = cached;
+    copy(200.e-6, 250.e-6, 1.);
+    EXPECT_EQ(cached.misses(), 1u);
+    EXPECT_EQ(cached.hits(), 0u);
+    cached(200.e-6, 250.e-6, 1.);
+    EXPECT_EQ(copy.hits(), 1u);
+    // outside of the table
+    cached(1.e-9, 250.e-6, 1.);
+    EXPECT_EQ(copy.misses(), 2u);
+}
+
+TEST(cached_kernal, allocates_tiles_on_first_use) {
+    // a full table would take about 1.6 GB at this tolerance
+    CachedCollisionKernal<HallCollisionKernal<Efficiencies>> cached({{}},
+                                                                    1.e-6);
+    EXPECT_EQ(cached.allocated_bytes(), 0u);
+    cached(200.e-6, 250.e-6, 1.);
+    EXPECT_GT(cached.allocated_bytes(), 0u);
+    EXPECT_LT(cached.allocated_bytes(), 1u << 20);
+}
+
+TEST(cached_kernal, box_collisions_stay_close_to_the_kernal) {
+    Grid grid{100., 100.};
+    SuperparticleStore sps = sdm_box(200);
+    CellIndex cells(grid);
+    cells.update(sps);
+    FallSpeedLU sedi;
+    auto exact = mkHCS(sedi)->collide(sps, cells, 0.1);
+    auto hcs = mkCachedHCS(sedi, 1.e-3);
+    hcs->collide(sps, cells, 0.1);
+    auto cached = hcs->collide(sps, cells, 0.1);
+    double dN = 0, error = 0;
+    for (size_t i = 0; i < sps.size(); ++i) {
+        dN += std::abs(exact[i].dN);
+        error += std::abs(cached[i].dN - exact[i].dN);
+    }
+    EXPECT_LT(error, 1.e-3 * dN);
+    auto counters = hcs->counters();
+    ASSERT_EQ(counters.size(), 2u);
+    EXPECT_EQ(counters[0].first, "kernal_cache_hits");
+    EXPECT_GT(counters[0].second, 0.);
+    EXPECT_TRUE(mkHCS(sedi)->counters().empty());
+}
+
+namespace {
+/// hall kernal counting its evaluations
+struct CountingKernal {
+    double operator()(double r, double R, double dfs) const {
+        ++*calls;
+        return hall(r, R, dfs);
+    }
+    HallCollisionKernal<Efficiencies> hall{{}};
+    std::shared_ptr<size_t> calls = std::make_shared<size_t>(0);
+};
+}  // namespace
+
+TEST(box_collisions, evaluate_every_pair_once) {
+    const size_t n = 50;
+    SuperparticleStore sps = sdm_box(n);
+    FallSpeedLU sedi;
+    CountingKernal kernal;
+    BoxCollisions<CountingKernal> bc(sedi, kernal);
+    std::vector<SpMassTendencies> mt(n);
+    bc.collide(sps.begin(), sps.end(), mt.begin(), 0.1);
+    EXPECT_EQ(*kernal.calls, n * (n - 1) / 2 + n);
+    // the sums over the partners of every particle, sdm_box is sorted
+    double qc = 0, dqc = 0;
+    for (size_t i = 0; i < n; ++i) {
+        double ri = sps.radius[i], fi = sedi.fall_speed(ri);
+        double dN = 0, mass = 0;
+        for (size_t j = 0; j < n; ++j) {
+            double rj = sps.radius[j], fj = sedi.fall_speed(rj);
+            if (j < i) {
+                mass += kernal.hall(rj, ri, fi - fj) * sps.N[j] * rj * rj * rj;
+            } else if (j > i) {
+                double k = kernal.hall(ri, rj, fi - fj);
+                dN -= k * sps.N[i] * sps.N[j];
+                mass -= k * sps.N[j] * ri * ri * ri;
+            }
+        }
+        EXPECT_NEAR(mt[i].dN, 0.1 * dN, 1.e-12 * std::abs(dN));
+        double expected = 4. / 3. * PI * RHO_H2O * sps.N[i] * 0.1 * mass;
+        EXPECT_NEAR(mt[i].dqc, expected, 1.e-12 * std::abs(expected));
+        qc += sps.qc[i];
+        dqc += mt[i].dqc;
+    }
+    EXPECT_NEAR(dqc, 0, 1.e-14 * qc);
+}
+
+TEST(hall_collision_kernal, rows_agree_with_the_scalar_kernal) {
+    HallCollisionKernal<Efficiencies> kernal({});
+    HallCollisionKernal<UnitEfficiencies> geometric({});
+    FallSpeedLU sedi;
+    // radii inside and outside of the efficiency table
+    std::vector<double> R, fs;
+    for (double x = 1.e-6; x < 1.e-3; x *= 1.01) {
+        R.push_back(x);
+        fs.push_back(sedi.fall_speed(x));
+    }
+    std::vector<double> k(R.size());
+    for (size_t i = 0; i < R.size(); i += 37) {
+        size_t n = R.size() - i;
+        kernal_row(kernal, R[i], fs[i], &R[i], &fs[i], &k[i], n);
+        for (size_t j = i; j < R.size(); ++j) {
+            double expected = kernal(R[i], R[j], fs[i] - fs[j]);
+            double scale = geometric(R[i], R[j], fs[i] - fs[j]);
+            EXPECT_NEAR(k[j], expected, 1.e-12 * scale)
+                << kernal_row_isa() << " " << R[i] << " " << R[j];
+        }
+    }
+}
+
+TEST(box_collisions, threads_give_the_serial_result) {
+    // populations growing with height, as below a cloud top
+    Grid grid{1000., 50.};
+    SuperparticleStore sps;
+    for (unsigned int l = 0; l < grid.n_lay; ++l) {
+        for (unsigned int i = 0; i < 3 * l; ++i) {
+            double r = 5.e-6 + 20.e-6 * i / (3. * l);
+            sps.push_back({cloud_water(int(1e8), r, 1.e-8, 1.),
+                           grid.getlay(l), 1.e-8, int(1e8) + int(i)});
+        }
+    }
+    CellIndex cells(grid);
+    cells.update(sps);
+    FallSpeedLU sedi;
+    auto serial = mkHCS(sedi)->collide(sps, cells, 0.1);
+    for (unsigned int threads : {2, 3, 8}) {
+        auto parallel = mkHCS(sedi, threads)->collide(sps, cells, 0.1);
+        ASSERT_EQ(parallel.size(), serial.size());
+        for (size_t i = 0; i < serial.size(); ++i) {
+            EXPECT_EQ(parallel[i].dN, serial[i].dN);
+            EXPECT_EQ(parallel[i].dqc, serial[i].dqc);
+        }
+        // on a pool shared with the condensation
+        ThreadPool pool(threads);
+        auto shared = mkHCS(sedi, pool)->collide(sps, cells, 0.1);
+        for (size_t i = 0; i < serial.size(); ++i) {
+            EXPECT_EQ(shared[i].dN, serial[i].dN);
+            EXPECT_EQ(shared[i].dqc, serial[i].dqc);
+        }
+    }
+}
+
+TEST(box_collisions, cached_kernals_collide_serially) {
+    FallSpeedLU sedi;
+    typedef CachedCollisionKernal<HallCollisionKernal<Efficiencies>> Cached;
+    BoxCollisionAdapter<BoxCollisions<Cached>> adapter(
+        BoxCollisions<Cached>(sedi, Cached({{}}, 1.e-3)), 4);
+    EXPECT_EQ(adapter.threads(), 1u);
+    BoxCollisionAdapter<BoxCollisions<HallCollisionKernal<Efficiencies>>>
+        hall(BoxCollisions<HallCollisionKernal<Efficiencies>>(sedi, {{}}), 4);
+    EXPECT_EQ(hall.threads(), 4u);
+    ThreadPool pool(4);
+    BoxCollisionAdapter<BoxCollisions<Cached>> shared(
+        BoxCollisions<Cached>(sedi, Cached({{}}, 1.e-3)), pool);
+    EXPECT_EQ(shared.threads(), 1u);
+}
+
+TEST(collisions, write_into_the_reused_buffer) {
+    Grid grid{100., 100.};
+    SuperparticleStore sps = sdm_box(20);
+    CellIndex cells(grid);
+    cells.update(sps);
+    FallSpeedLU sedi;
+    auto hall = mkHCS(sedi);
+    std::vector<SpMassTendencies> tendencies(sps.size(), {1., 1.});
+    const SpMassTendencies* data = tendencies.data();
+    hall->collide(sps, cells, 0.1, tendencies);
+    EXPECT_EQ(tendencies.data(), data);
+    auto fresh = hall->collide(sps, cells, 0.1);
+    ASSERT_EQ(tendencies.size(), fresh.size());
+    for (size_t i = 0; i < sps.size(); ++i) {
+        EXPECT_EQ(tendencies[i].dN, fresh[i].dN);
+        EXPECT_EQ(tendencies[i].dqc, fresh[i].dqc);
+    }
+    // particles outside of the boxes get no tendencies
+    sps.push_back({0.00001, 50., 1.e-6, int(1e8)});
+    sps.is_nucleated[sps.size() - 1] = false;
+    cells.update(sps);
+    hall->collide(sps, cells, 0.1, tendencies);
+    EXPECT_EQ(tendencies.back().dN, 0.);
+    mkNCS()->collide(sps, cells, 0.1, tendencies);
+    EXPECT_TRUE(tendencies.empty());
+    EXPECT_EQ(mkNCS()->collide(sps, cells, 0.1).size(), sps.size());
+}
+
+TEST(box_collisions, skip_quiescent_boxes) {
+    // fresh small droplets in the lower layer, a drizzle spectrum above
+    Grid grid{200., 100.};
+    SuperparticleStore sps;
+    for (int i = 0; i < 10; ++i) {
+        double r = 2.e-6 + 1.e-9 * i;
+        sps.push_back({cloud_water(int(1e6), r, 1.e-8, 1.), 50., 1.e-8,
+                       int(1e6)});
+    }
+    for (int i = 0; i < 10; ++i) {
+        double r = 5.e-6 + 10.e-6 * i;
+        sps.push_back({cloud_water(int(1e8), r, 1.e-8, 1.), 150., 1.e-8,
+                       int(1e8)});
+    }
+    CellIndex cells(grid);
+    cells.update(sps);
+    FallSpeedLU sedi;
+    BoxCollisions<HallCollisionKernal<Efficiencies>> bc(sedi, {{}});
+    double quiet = bc.activity(indexed_iterator(sps.begin(), cells[0].begin()),
+                               indexed_iterator(sps.begin(), cells[0].end()),
+                               0.1);
+    double active = bc.activity(
+        indexed_iterator(sps.begin(), cells[1].begin()),
+        indexed_iterator(sps.begin(), cells[1].end()), 0.1);
+    ASSERT_LT(quiet, 1.e-6);
+    ASSERT_GT(active, 1.e-6);
+
+    auto all = mkHCS(sedi)->collide(sps, cells, 0.1);
+    auto hall = mkHCS(sedi, 1, 1.e-6);
+    for (int step = 0; step < 2; ++step) {
+        auto masked = hall->collide(sps, cells, 0.1);
+        for (size_t i = 0; i < sps.size(); ++i) {
+            bool skipped = i < 10;
+            EXPECT_EQ(masked[i].dN, skipped ? 0. : all[i].dN);
+            EXPECT_EQ(masked[i].dqc, skipped ? 0. : all[i].dqc);
+        }
+    }
+    // counts of the last step
+    auto counters = hall->step_counters();
+    ASSERT_EQ(counters.size(), 2u);
+    EXPECT_EQ(counters[0].first, "collision_boxes_computed");
+    EXPECT_EQ(counters[0].second, 1.);
+    EXPECT_EQ(counters[1].first, "collision_boxes_skipped");
+    EXPECT_EQ(counters[1].second, 1.);
+    EXPECT_TRUE(hall->counters().empty());
+
+    // without skipping every populated box is computed
+    auto every = mkHCS(sedi);
+    every->collide(sps, cells, 0.1);
+    counters = every->step_counters();
+    EXPECT_EQ(counters[0].second, 2.);
+    EXPECT_EQ(counters[1].second, 0.);
+}
+
+TEST(box_collisions, joined_layers_keep_the_collision_rate) {
+    // the same spectrum in two layers of five, with empty layers below
+    // and above, as around a cloud
+    Grid grid{500., 100.};
+    SuperparticleStore sps;
+    for (double z : {150., 250.}) {
+        for (int i = 0; i < 10; ++i) {
+            double r = 5.e-6 + 3.e-6 * i;
+            sps.push_back({cloud_water(int(1e8), r, 1.e-8, 1.), z, 1.e-8,
+                           int(1e8)});
+        }
+    }
+    CellIndex cells(grid);
+    cells.update(sps);
+    FallSpeedLU sedi;
+    auto layers = mkHCS(sedi)->collide(sps, cells, 0.1);
+    // a drop never collides with its copy of equal fall speed, so a box of
+    // both layers at dt / 2 sees the same rates
+    auto joined = mkHCS(sedi, 1, 0., 2)->collide(sps, cells, 0.1);
+    // 15 particles take both layers and the empty one below, the empty top
+    // layers join them. Empty layers do not dilute the rates
+    auto adaptive = mkHCS(sedi, 1, 0., 1, 15)->collide(sps, cells, 0.1);
+    for (size_t i = 0; i < sps.size(); ++i) {
+        EXPECT_NEAR(joined[i].dN, layers[i].dN, 1.e-12 * std::abs(layers[i].dN));
+        EXPECT_NEAR(joined[i].dqc, layers[i].dqc,
+                    1.e-12 * std::abs(layers[i].dqc));
+        EXPECT_NEAR(adaptive[i].dN, layers[i].dN,
+                    1.e-12 * std::abs(layers[i].dN));
+        EXPECT_NEAR(adaptive[i].dqc, layers[i].dqc,
+                    1.e-12 * std::abs(layers[i].dqc));
+    }
+}
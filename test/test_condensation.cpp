@@ -0,0 +1,187 @@
+#include <random>
+#include <vector>
+#include "cell_index.h"
+#include "collision.h"
+#include "condensation.h"
+#include "grid.h"
+#include "gtest/gtest.h"
+#include "saturation_fluctuations.h"
+#include "sedimentation.h"
+#include "state.h"
+#include "superparticle_store.h"
+#include "thermodynamic.h"
+#include "thread_pool.h"
+
+static State make_state(const Grid& grid) {
+    State state{0, {}, {}, grid, 500., 1.};
+    for (unsigned int i = 0; i < grid.n_lay; ++i) {
+        double T = 285. - 0.006 * grid.getlay(i);
+        double p = 95000.;
+        state.layers.push_back({T, p, saturation_vapor(T, p) * 1.01, 0.});
+    }
+    for (unsigned int i = 0; i < grid.n_lvl; ++i) {
+        state.levels.push_back({1., 95000.});
+    }
+    return state;
+}
+
+static SuperparticleStore make_superparticles(const Grid& grid, size_t n) {
+    std::mt19937_64 gen(7);
+    std::uniform_real_distribution<> zdis(1., grid.height - 10.);
+    std::uniform_real_distribution<> qcdis(1.e-6, 1.e-4);
+    SuperparticleStore sps;
+    for (size_t i = 0; i < n; ++i) {
+        sps.push_back({qcdis(gen), zdis(gen), 1.e-8, 10000000});
+    }
+    return sps;
+}
+
+static void run(unsigned int threads, State& state, SuperparticleStore& sps,
+                int steps = 10, bool fused = false) {
+    FallSpeedLU sedi;
+    NoFluctuationSolver fluctuations;
+    Condensation condensation(sedi, threads, fused);
+    for (int step = 0; step < steps; ++step) {
+        state.freeze();
+        condensation.condense(state, sps, fluctuations, 0.1);
+    }
+}
+
+TEST(condensation_phase, is_reproducible_for_a_thread_count) {
+    Grid grid{500., 5.};
+    State s0 = make_state(grid);
+    State s1 = make_state(grid);
+    auto sps0 = make_superparticles(grid, 5000);
+    auto sps1 = sps0;
+    run(4, s0, sps0);
+    run(4, s1, sps1);
+    for (size_t l = 0; l < grid.n_lay; ++l) {
+        EXPECT_EQ(s0.layers[l].qv, s1.layers[l].qv);
+    }
+    EXPECT_EQ(s0.qr_ground, s1.qr_ground);
+}
+
+TEST(condensation_phase, threads_match_serial_run) {
+    Grid grid{500., 5.};
+    State serial = make_state(grid);
+    State parallel = make_state(grid);
+    auto sps_serial = make_superparticles(grid, 5000);
+    auto sps_parallel = sps_serial;
+    run(1, serial, sps_serial, 1);
+    run(3, parallel, sps_parallel, 1);
+    // within one step the particles see the same frozen layers, only the
+    // order of the reduction into the state differs
+    for (size_t i = 0; i < sps_serial.size(); ++i) {
+        EXPECT_EQ(sps_serial.qc[i], sps_parallel.qc[i]);
+        EXPECT_EQ(sps_serial.z[i], sps_parallel.z[i]);
+    }
+    for (size_t l = 0; l < grid.n_lay; ++l) {
+        EXPECT_NEAR(serial.layers[l].qv, parallel.layers[l].qv,
+                    1.e-12 * serial.layers[l].qv);
+    }
+}
+
+TEST(condensation_phase, rethrows_broken_cfl_criterion) {
+    Grid grid{500., 5.};
+    State state = make_state(grid);
+    for (auto& lvl : state.levels) {
+        lvl.w = 100.;
+    }
+    auto sps = make_superparticles(grid, 100);
+    FallSpeedLU sedi;
+    NoFluctuationSolver fluctuations;
+    Condensation condensation(sedi, 2);
+    state.freeze();
+    EXPECT_THROW(condensation.condense(state, sps, fluctuations, 0.1),
+                 std::logic_error);
+}
+
+TEST(condensation_phase, fused_kernel_matches_phased_kernel) {
+    Grid grid{500., 5.};
+    for (unsigned int threads : {1u, 3u}) {
+        State phased = make_state(grid);
+        State fused = make_state(grid);
+        auto sps_phased = make_superparticles(grid, 5000);
+        auto sps_fused = sps_phased;
+        run(threads, phased, sps_phased, 10, false);
+        run(threads, fused, sps_fused, 10, true);
+        for (size_t i = 0; i < sps_phased.size(); ++i) {
+            EXPECT_EQ(sps_phased.qc[i], sps_fused.qc[i]);
+            EXPECT_EQ(sps_phased.z[i], sps_fused.z[i]);
+            EXPECT_EQ(sps_phased.v[i], sps_fused.v[i]);
+        }
+        for (size_t l = 0; l < grid.n_lay; ++l) {
+            EXPECT_EQ(phased.layers[l].qv, fused.layers[l].qv);
+        }
+    }
+}
+
+TEST(condensation_phase, shares_its_pool_with_the_collisions) {
+    Grid grid{500., 5.};
+    State own = make_state(grid);
+    State shared = make_state(grid);
+    auto sps_own = make_superparticles(grid, 2000);
+    auto sps_shared = sps_own;
+    run(3, own, sps_own, 5);
+
+    FallSpeedLU sedi;
+    NoFluctuationSolver fluctuations;
+    ThreadPool pool(3);
+    Condensation condensation(sedi, pool);
+    auto collisions = mkHCS(sedi, pool);
+    CellIndex cells(grid);
+    EXPECT_EQ(condensation.threads(), 3u);
+    for (int step = 0; step < 5; ++step) {
+        shared.freeze();
+        condensation.condense(shared, sps_shared, fluctuations, 0.1);
+        cells.update(sps_shared);
+        collisions->collide(sps_shared, cells, 0.1);
+    }
+    for (size_t l = 0; l < grid.n_lay; ++l) {
+        EXPECT_EQ(own.layers[l].qv, shared.layers[l].qv);
+    }
+}
+
+TEST(condensation_phase, markov_fluctuations_do_not_depend_on_partitioning) {
+    Grid grid{500., 5.};
+    FallSpeedLU sedi;
+    // serial phased, parallel phased and parallel fused
+    const unsigned int threads[] = {1, 3, 3};
+    const bool fused[] = {false, false, true};
+    std::vector<SuperparticleStore> sps(3, make_superparticles(grid, 1000));
+    for (int k = 0; k < 3; ++k) {
+        State state = make_state(grid);
+        std::mt19937_64 gen(3);
+        MarkovFluctuationSolver<std::mt19937_64> fluctuations(gen, 50.e-4,
+                                                              100., grid);
+        CellIndex cells(grid);
+        cells.update(sps[k]);
+        fluctuations.refresh(sps[k], cells);
+        Condensation condensation(sedi, threads[k], fused[k]);
+        state.freeze();
+        condensation.condense(state, sps[k], fluctuations, 0.1);
+    }
+    for (int k = 1; k < 3; ++k) {
+        for (size_t i = 0; i < sps[0].size(); ++i) {
+            EXPECT_EQ(sps[0].S_prime[i], sps[k].S_prime[i]);
+            EXPECT_EQ(sps[0].w_prime[i], sps[k].w_prime[i]);
+            EXPECT_EQ(sps[0].qc[i], sps[k].qc[i]);
+        }
+    }
+}
+
+TEST(condensation_phase, fused_kernel_checks_superparticles) {
+    if (!Validator::cheap) {
+        GTEST_SKIP() << "particle checks are compiled out";
+    }
+    Grid grid{500., 5.};
+    State state = make_state(grid);
+    auto sps = make_superparticles(grid, 100);
+    sps.qc[42] = -1.;
+    FallSpeedLU sedi;
+    NoFluctuationSolver fluctuations;
+    Condensation condensation(sedi, 1, true);
+    state.freeze();
+    EXPECT_THROW(condensation.condense(state, sps, fluctuations, 0.1),
+                 std::logic_error);
+}
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "diagnostics.h"
+#include "gtest/gtest.h"
+#include "superparticle.h"
+#include "thread_pool.h"
+
+TEST(diagnostics, counts_and_keeps_first_samples) {
+    DiagnosticChannel channel;
+    for (int i = 0; i < 10; ++i) {
+        channel.report(Diagnostic::large_drop, i);
+    }
+    EXPECT_EQ(channel.pending(Diagnostic::large_drop), 10u);
+    std::vector<DiagnosticChannel::Summary> summaries;
+    channel.drain([&](const DiagnosticChannel::Summary& s) {
+        summaries.push_back(s);
+    });
+    ASSERT_EQ(summaries.size(), 1u);
+    EXPECT_EQ(summaries[0].event, Diagnostic::large_drop);
+    EXPECT_EQ(summaries[0].count, 10u);
+    EXPECT_EQ(summaries[0].n_samples, size_t(DiagnosticChannel::max_samples));
+    EXPECT_EQ(summaries[0].samples[1], 1.);
+    EXPECT_EQ(channel.pending(Diagnostic::large_drop), 0u);
+}
+
+TEST(diagnostics, counts_reports_of_all_threads) {
+    DiagnosticChannel channel;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&channel] {
+            for (int i = 0; i < 1000; ++i) {
+                channel.report(Diagnostic::particle_reached_ground, 1.e-5);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(channel.pending(Diagnostic::particle_reached_ground), 4000u);
+}
+
+TEST(diagnostics, print_is_one_line_per_event_and_interval) {
+    DiagnosticChannel channel;
+    for (int i = 0; i < 100; ++i) {
+        channel.report(Diagnostic::particle_reached_ground, 1.e-5);
+    }
+    channel.report(Diagnostic::unordered_interpolation, 2.);
+    std::ostringstream os;
+    print_diagnostics(os, channel);
+    std::string out = os.str();
+    EXPECT_EQ(std::count(out.begin(), out.end(), '\n'), 2);
+    EXPECT_NE(out.find("100 times, 100 in total"), std::string::npos);
+    channel.report(Diagnostic::particle_reached_ground, 1.e-5);
+    std::ostringstream os2;
+    print_diagnostics(os2, channel);
+    EXPECT_NE(os2.str().find("1 times, 101 in total"), std::string::npos);
+}
+
+TEST(diagnostics, nucleation_reports_particles_on_the_ground) {
+    auto before = diagnostics().pending(Diagnostic::particle_reached_ground);
+    EXPECT_FALSE(nucleation(1.e-5, -0.1, 100, 1.e-5));
+    EXPECT_EQ(diagnostics().pending(Diagnostic::particle_reached_ground),
+              before + 1);
+}
+
+TEST(diagnostics, scopes_select_the_channel_of_a_thread) {
+    DiagnosticChannel a, b;
+    auto before = diagnostics().pending(Diagnostic::large_drop);
+    std::thread other([&b] {
+        DiagnosticScope scope(b);
+        report(Diagnostic::large_drop, 2.);
+    });
+    {
+        DiagnosticScope scope(a);
+        report(Diagnostic::large_drop, 1.);
+        EXPECT_EQ(&diagnostics(), &a);
+    }
+    other.join();
+    EXPECT_EQ(a.pending(Diagnostic::large_drop), 1u);
+    EXPECT_EQ(b.pending(Diagnostic::large_drop), 1u);
+    EXPECT_EQ(diagnostics().pending(Diagnostic::large_drop), before);
+}
+
+TEST(diagnostics, pool_workers_report_to_the_channel_of_the_caller) {
+    DiagnosticChannel channel;
+    ThreadPool pool(4);
+    DiagnosticScope scope(channel);
+    pool.run(100, [](size_t) { report(Diagnostic::large_drop, 1.); });
+    EXPECT_EQ(channel.pending(Diagnostic::large_drop), 100u);
+}
@@ -32,3 +32,18 @@ TEST(collision_efficiencies, test_up_left){
     double test = 0.0001;
     EXPECT_DOUBLE_EQ(effi.collision_efficiency(R, rR), test);
 }
+
+TEST(collision_efficiencies, uniform_table_agrees_with_the_hall_table){
+    Efficiencies effi;
+    UniformEfficiencies uniform;
+    // inside of the table and extrapolated beyond its edges
+    for (double R = 1.; R < 500.; R += 0.7) {
+        for (double rR = 0.01; rR <= 1.; rR += 0.003) {
+            EXPECT_NEAR(uniform.collision_efficiency(R, rR),
+                        effi.collision_efficiency(R, rR), 1.e-12)
+                << R << " " << rR;
+        }
+    }
+    EXPECT_DOUBLE_EQ(uniform.collision_efficiency(250., 0.075),
+                     ((0.87 + 0.96) + (1.00 + 0.97)) / 4.);
+}
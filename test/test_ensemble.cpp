@@ -0,0 +1,88 @@
+#include <yaml-cpp/yaml.h>
+#include <stdexcept>
+#include "ensemble.h"
+#include "gtest/gtest.h"
+
+static YAML::Node ensemble_config(const std::string& ensemble) {
+    return YAML::Load(
+        "model:\n"
+        "    dt: 0.05\n"
+        "    initial_state: {w: 1., p0: 101500.}\n"
+        "ensemble:\n" +
+        ensemble);
+}
+
+TEST(ensemble, seed_range) {
+    auto members =
+        createEnsemble(ensemble_config("    seeds: {first: 3, count: 4}\n"));
+    ASSERT_EQ(members.size(), 4u);
+    for (size_t i = 0; i < members.size(); ++i) {
+        EXPECT_EQ(members[i].seed, 3 + i);
+        EXPECT_EQ(members[i].name, "seed_" + std::to_string(3 + i));
+        EXPECT_EQ(members[i].model["dt"].as<double>(), 0.05);
+    }
+}
+
+TEST(ensemble, member_overrides_are_merged) {
+    auto members = createEnsemble(
+        ensemble_config("    members:\n"
+                        "      - seed: 7\n"
+                        "        name: updraft\n"
+                        "        model: {initial_state: {w: 3.}}\n"
+                        "      - seed: 8\n"));
+    ASSERT_EQ(members.size(), 2u);
+    EXPECT_EQ(members[0].name, "updraft");
+    EXPECT_EQ(members[0].model["initial_state"]["w"].as<double>(), 3.);
+    EXPECT_EQ(members[0].model["initial_state"]["p0"].as<double>(), 101500.);
+    EXPECT_EQ(members[0].model["dt"].as<double>(), 0.05);
+    EXPECT_EQ(members[1].name, "seed_8");
+    EXPECT_EQ(members[1].model["initial_state"]["w"].as<double>(), 1.);
+}
+
+TEST(ensemble, members_own_their_configuration) {
+    auto config = ensemble_config("    seeds: {first: 0, count: 2}\n");
+    auto members = createEnsemble(config);
+    members[0].model["dt"] = 1.;
+    EXPECT_EQ(members[1].model["dt"].as<double>(), 0.05);
+    EXPECT_EQ(config["model"]["dt"].as<double>(), 0.05);
+}
+
+TEST(ensemble, rejects_empty_and_duplicate_members) {
+    EXPECT_THROW(createEnsemble(ensemble_config("    threads: 2\n")),
+                 std::logic_error);
+    EXPECT_THROW(createEnsemble(ensemble_config(
+                     "    seeds: {first: 1, count: 1}\n"
+                     "    members:\n"
+                     "      - seed: 1\n")),
+                 std::logic_error);
+}
+
+namespace {
+/// records whether the io mutex is held while it is destroyed
+class ClosingLogger : public Logger {
+   public:
+    ClosingLogger(std::mutex& m, bool& locked) : m(m), locked(locked) {}
+    ~ClosingLogger() override {
+        locked = !m.try_lock();
+        if (!locked) {
+            m.unlock();
+        }
+    }
+    void log(const State& state, const SuperparticleStore& superparticles,
+             const CellIndex& cells) override {}
+
+   private:
+    std::mutex& m;
+    bool& locked;
+};
+}  // namespace
+
+TEST(ensemble, loggers_are_closed_under_the_io_lock) {
+    std::mutex m;
+    bool locked = false;
+    {
+        SynchronizedLogger logger(std::make_unique<ClosingLogger>(m, locked),
+                                  m);
+    }
+    EXPECT_TRUE(locked);
+}
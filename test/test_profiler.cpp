@@ -0,0 +1,95 @@
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cell_index.h"
+#include "grid.h"
+#include "gtest/gtest.h"
+#include "profiler.h"
+#include "superparticle_store.h"
+
+TEST(profiler, nearest_rank_percentile) {
+    std::vector<double> samples{5., 1., 4., 2., 3.};
+    EXPECT_EQ(percentile(samples, 0.), 1.);
+    EXPECT_EQ(percentile(samples, 0.5), 3.);
+    EXPECT_EQ(percentile(samples, 1.), 5.);
+    EXPECT_EQ(percentile({}, 0.5), 0.);
+}
+
+TEST(profiler, scopes_add_up_within_a_step) {
+    Grid grid{3., 1.};
+    SuperparticleStore sps;
+    CellIndex cells(grid);
+    BasicStepProfiler<true> profiler;
+    for (int i = 0; i < 2; ++i) {
+        BasicStepProfiler<true>::Scope timer(profiler, Phase::collisions);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    profiler.end_step(sps, cells);
+    {
+        BasicStepProfiler<true>::Scope timer(profiler, Phase::collisions);
+    }
+    profiler.end_step(sps, cells);
+    ASSERT_EQ(profiler.steps(), 2u);
+    const auto& t = profiler.phase_samples(Phase::collisions);
+    ASSERT_EQ(t.size(), 2u);
+    EXPECT_GE(t[0], 0.004);
+    EXPECT_LT(t[1], t[0]);
+    EXPECT_EQ(profiler.phase_samples(Phase::radiation)[0], 0.);
+}
+
+TEST(profiler, report_holds_phases_and_occupancy) {
+    Grid grid{3., 1.};
+    SuperparticleStore sps;
+    sps.push_back({0.00001, 0.5, 1.e-6, int(1e8)});
+    sps.push_back({0.00001, 0.7, 1.e-6, int(1e8)});
+    sps.push_back({0.00001, 2.5, 1.e-6, int(1e8)});
+    CellIndex cells(grid);
+    cells.update(sps);
+    BasicStepProfiler<true> profiler;
+    profiler.end_step(sps, cells);
+    std::ostringstream os;
+    profiler.report(os);
+    std::string report = os.str();
+    EXPECT_NE(report.find("\"steps\": 1"), std::string::npos);
+    EXPECT_NE(report.find("\"condensation\": {\"mean\""), std::string::npos);
+    EXPECT_NE(report.find("\"fraction\""), std::string::npos);
+    EXPECT_NE(report.find("\"superparticles\": {\"mean\": 3"),
+              std::string::npos);
+    EXPECT_NE(report.find("\"mean\": [2, 0, 1]"), std::string::npos);
+    EXPECT_NE(report.find("\"max\": [2, 0, 1]"), std::string::npos);
+}
+
+TEST(profiler, samples_step_counts) {
+    Grid grid{3., 1.};
+    SuperparticleStore sps;
+    CellIndex cells(grid);
+    BasicStepProfiler<true> profiler;
+    for (int step = 0; step < 3; ++step) {
+        profiler.count({{"boxes", double(step)}, {"skipped", 1.}});
+        profiler.end_step(sps, cells);
+    }
+    EXPECT_EQ(profiler.count_samples("boxes"), (std::vector<double>{0, 1, 2}));
+    EXPECT_EQ(profiler.count_samples("skipped").size(), 3u);
+    EXPECT_TRUE(profiler.count_samples("other").empty());
+    std::ostringstream os;
+    profiler.report(os);
+    std::string report = os.str();
+    EXPECT_NE(report.find("\"boxes\": {\"mean\": 1"), std::string::npos);
+    EXPECT_NE(report.find("\"total\": 3"), std::string::npos);
+}
+
+TEST(profiler, disabled_profiler_records_nothing) {
+    Grid grid{3., 1.};
+    SuperparticleStore sps;
+    CellIndex cells(grid);
+    BasicStepProfiler<false> profiler;
+    {
+        BasicStepProfiler<false>::Scope timer(profiler, Phase::advection);
+    }
+    profiler.end_step(sps, cells);
+    EXPECT_EQ(profiler.steps(), 0u);
+    std::ostringstream os;
+    profiler.report(os);
+    EXPECT_NE(os.str().find("\"disabled\": true"), std::string::npos);
+}
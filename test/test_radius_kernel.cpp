@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "gtest/gtest.h"
+#include "radius_kernel.h"
+#include "superparticle_store.h"
+#include "thermodynamic.h"
+
+TEST(radius_kernel, fast_cbrt_error_bound) {
+    double max_error = 0;
+    // std::pow(x, 1. / 3.) is off by |ln x| 1e-17, as 1 / 3 is rounded
+    for (double e = -300; e <= 300; e += 1.e-2) {
+        double x = std::pow(10., e);
+        double ref = std::cbrt(x);
+        max_error = std::max(max_error, std::abs(fast_cbrt(x) - ref) / ref);
+    }
+    EXPECT_LT(max_error, 2.e-15);
+}
+
+TEST(radius_kernel, fast_cbrt_range_edges) {
+    // below the float range, where a float first guess is zero
+    for (double x : {std::numeric_limits<double>::min(), 1.e-300, 1.e-45,
+                     1.e-39, 1.e39, 1.e300,
+                     std::numeric_limits<double>::max()}) {
+        double ref = std::cbrt(x);
+        EXPECT_NEAR(fast_cbrt(x), ref, 2.e-15 * ref) << x;
+    }
+    EXPECT_EQ(fast_cbrt(0.), 0.);
+}
+
+TEST(radius_kernel, batch_matches_radius) {
+    std::vector<double> qc{1.e-9, 1.e-5, 3.e-4, 0.};
+    std::vector<int> N{1, 100000000, 1000, 50};
+    std::vector<double> r_dry{1.e-8, 1.e-6, 1.e-7, 1.e-9};
+    std::vector<double> r(qc.size());
+    batch_radius(qc.data(), N.data(), r_dry.data(), r.data(), qc.size(), 1.);
+    for (size_t i = 0; i < qc.size(); ++i) {
+        double ref = radius(qc[i], N[i], r_dry[i], 1.);
+        EXPECT_NEAR(r[i], ref, 2.e-15 * ref);
+    }
+}
+
+TEST(radius_kernel, update_radii_keeps_dead_particles_dead) {
+    SuperparticleStore sps;
+    sps.push_back({0.00001, 1.5, 1.e-6, int(1e8)});
+    sps.push_back({0.00001, 2.5, 1.e-6, int(1e8)});
+    sps.push_back({0.00001, 3.5, 1.e-6, int(1e8)});
+    sps.is_nucleated[1] = false;
+    sps.qc[0] = 0.00002;
+    sps.qc[1] = 0.00002;
+    sps.z[2] = -0.1;
+    sps.update_radii(0, sps.size());
+    EXPECT_NEAR(sps.radius[0], radius(2.e-5, 1e8, 1.e-6, 1.),
+                2.e-15 * sps.radius[0]);
+    EXPECT_TRUE(sps.is_nucleated[0]);
+    EXPECT_FALSE(sps.is_nucleated[1]);
+    EXPECT_FALSE(sps.is_nucleated[2]);
+}
@@ -1,10 +1,11 @@
 #include <vector>
 #include <fstream>
 #include <iostream>
+#include "cell_index.h"
 #include "grid.h"
 #include "gtest/gtest.h"
 #include "saturation_fluctuations.h"
-#include "superparticle.h"
+#include "superparticle_store.h"
 
 TEST(saturation_fluctuations, test_tke){
     double EPSILON = 1.e-2;
@@ -43,7 +44,7 @@ TEST(saturation_fluctuations, test_saturation_fluctuations){
     std::mt19937_64 gen(rd());
     Grid  grid{300., 100.};
 
-    std::vector<Superparticle> sp;
+    SuperparticleStore sp;
     sp.push_back({0.00001, 50, 1.e-6, 100000000, true});
 
     auto fsolver = mkFS(gen, "markov", 50.e-4, 50, grid);
@@ -53,10 +54,73 @@ TEST(saturation_fluctuations, test_saturation_fluctuations){
 
     std::ofstream mfile;
     mfile.open("./test/test_saturation_fluctuations.txt");
+    CellIndex cells(grid);
+    cells.update(sp);
     for (int t = 0; t< tmax;++t){
-        fsolver->refresh(sp);
+        fsolver->refresh(sp, cells);
         fsolver->getFluctuation(sp[0], dt);
         mfile << sp[0].S_prime << " " << sp[0].w_prime << "\n";
     }
     mfile.close();
 }
+
+TEST(saturation_fluctuations, philox_known_answers){
+    // known answer vectors of the Random123 reference implementation
+    typedef Philox4x32::ctr_type ctr;
+    EXPECT_EQ(Philox4x32::apply({0, 0, 0, 0}, {0, 0}),
+              (ctr{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(Philox4x32::apply({0xffffffff, 0xffffffff, 0xffffffff,
+                                 0xffffffff},
+                                {0xffffffff, 0xffffffff}),
+              (ctr{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    EXPECT_EQ(Philox4x32::apply({0x243f6a88, 0x85a308d3, 0x13198a2e,
+                                 0x03707344},
+                                {0xa4093822, 0x299f31d0}),
+              (ctr{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+TEST(saturation_fluctuations, philox_normal_moments){
+    const int n = 200000;
+    double sum = 0.;
+    double sum2 = 0.;
+    for (int i = 0; i < n; ++i) {
+        double x = philox_normal(7, i % 1000, i / 1000);
+        sum += x;
+        sum2 += x * x;
+    }
+    EXPECT_NEAR(sum / n, 0., 0.01);
+    EXPECT_NEAR(sum2 / n, 1., 0.01);
+}
+
+TEST(saturation_fluctuations, markov_draws_follow_the_particle){
+    Grid grid{300., 100.};
+    SuperparticleStore sp;
+    for (int i = 0; i < 10; ++i) {
+        sp.push_back({0.00001, 50. + 10. * i, 1.e-6, 100000000});
+    }
+    SuperparticleStore reversed = sp;
+    reversed.permute({9, 8, 7, 6, 5, 4, 3, 2, 1, 0});
+
+    std::mt19937_64 gen0(5);
+    std::mt19937_64 gen1(5);
+    MarkovFluctuationSolver<std::mt19937_64> f0(gen0, 50.e-4, 50, grid);
+    MarkovFluctuationSolver<std::mt19937_64> f1(gen1, 50.e-4, 50, grid);
+    CellIndex cells0(grid);
+    CellIndex cells1(grid);
+    for (int t = 0; t < 5; ++t) {
+        cells0.update(sp);
+        cells1.update(reversed);
+        f0.refresh(sp, cells0);
+        f1.refresh(reversed, cells1);
+        for (size_t i = 0; i < sp.size(); ++i) {
+            f0.getFluctuation(sp[i], 0.1);
+            f1.getFluctuation(reversed[i], 0.1);
+        }
+    }
+    for (size_t i = 0; i < sp.size(); ++i) {
+        EXPECT_EQ(sp.id[i], reversed.id[9 - i]);
+        EXPECT_EQ(sp.w_prime[i], reversed.w_prime[9 - i]);
+        EXPECT_EQ(sp.S_prime[i], reversed.S_prime[9 - i]);
+    }
+    EXPECT_NE(sp.w_prime[0], sp.w_prime[1]);
+}
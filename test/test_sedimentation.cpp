@@ -1,5 +1,52 @@
+#include <vector>
 #include "gtest/gtest.h"
 #include "sedimentation.h"
 
+/// the measured speeds interpolated by a search of the diameters
+static double searched_fall_speed(double r) {
+    if (r < fall_speed_diameters[0] / 2000.) {
+        return std::min(1.19e8 * r * r, 10.);
+    }
+    std::vector<double> radii;
+    for (double d : fall_speed_diameters) {
+        radii.push_back(d / 2000.);
+    }
+    int idx = left_index_min_zero_max_smallerlast(radii, r);
+    return std::min(linear_interpolate(radii[idx], fall_speed_values[idx],
+                                       radii[idx + 1],
+                                       fall_speed_values[idx + 1], r),
+                    10.);
+}
+
 TEST(sedimentation, test_fall_speed_values){
+    FallSpeedLU sedi;
+    EXPECT_DOUBLE_EQ(sedi.fall_speed(0.5e-3), 4.03);
+    EXPECT_DOUBLE_EQ(sedi.fall_speed(0.55e-3), (4.03 + 4.64) / 2.);
+    EXPECT_DOUBLE_EQ(sedi.fall_speed(2.e-5), 1.19e8 * 2.e-5 * 2.e-5);
+    EXPECT_EQ(sedi.fall_speed(1.), 10.);
+}
+
+TEST(sedimentation, uniform_table_agrees_with_the_search){
+    FallSpeedLU sedi;
+    // below, inside of and extrapolated beyond the measurements
+    for (double r = 1.e-7; r < 5.e-3; r += 1.3e-7) {
+        EXPECT_NEAR(sedi.fall_speed(r), searched_fall_speed(r), 1.e-12) << r;
+    }
+}
+
+TEST(sedimentation, batch_agrees_with_single_radii){
+    FallSpeedLU lookup;
+    NoFallSpeed none;
+    std::vector<double> r, v(1000, -1.);
+    for (size_t i = 0; i < v.size(); ++i) {
+        r.push_back(1.e-7 + 5.e-6 * i);
+    }
+    for (const Sedimentation* sedi :
+         {static_cast<const Sedimentation*>(&lookup),
+          static_cast<const Sedimentation*>(&none)}) {
+        sedi->fall_speed(r.data(), v.data(), r.size());
+        for (size_t i = 0; i < r.size(); ++i) {
+            EXPECT_DOUBLE_EQ(v[i], sedi->fall_speed(r[i])) << r[i];
+        }
+    }
 }
@@ -1,6 +1,12 @@
 #include "gtest/gtest.h"
 #include "state.h"
 #include <algorithm>
+#include "alloc_counter.h"
+#include "condensation.h"
+#include "grid.h"
+#include "saturation_fluctuations.h"
+#include "sedimentation.h"
+#include "superparticle_store.h"
 
 //TEST(state, swap_is_deep){
 //    State s0{0,{{0},1},{{0}, 1},{{0},1},{{0},1},{{0}, 1}};
@@ -9,3 +15,65 @@
 //    EXPECT_TRUE(s0.w(0.5, 1) == 1);
 //    EXPECT_TRUE(s1.w(0.5, 1) == 0);
 //}
+
+static State make_state(const Grid& grid) {
+    State state{0, {}, {}, grid, 500., 1.};
+    for (unsigned int i = 0; i < grid.n_lay; ++i) {
+        state.layers.push_back({280., 90000., 0.01, 0.});
+    }
+    for (unsigned int i = 0; i < grid.n_lvl; ++i) {
+        state.levels.push_back({1., 90000.});
+    }
+    return state;
+}
+
+TEST(state, frozen_layers_do_not_see_changes){
+    Grid grid{3000., 1.};
+    State state = make_state(grid);
+    state.freeze();
+    state.change_layer(10.5, {0, 0, -0.001, 0});
+    EXPECT_DOUBLE_EQ(state.frozen_layer_at(10.5).qv, 0.01);
+    EXPECT_DOUBLE_EQ(state.layer_at(10.5).qv, 0.009);
+    state.freeze();
+    EXPECT_DOUBLE_EQ(state.frozen_layer_at(10.5).qv, 0.009);
+}
+
+TEST(state, freeze_and_condensation_do_not_allocate_after_warm_up){
+    // the frozen layers and condensation of a model step. Advection,
+    // particle generation, radiation and the hall collider, which sorts
+    // every box into new columns, still allocate per step
+    Grid grid{500., 5.};
+    State state = make_state(grid);
+    SuperparticleStore sps;
+    for (int i = 0; i < 2000; ++i) {
+        sps.push_back({1.e-5 * (1 + i % 7), 1. + (i * 37) % 490, 1.e-8,
+                       10000000});
+    }
+    FallSpeedLU sedi;
+    NoFluctuationSolver fluctuations;
+    for (unsigned int threads : {1u, 3u}) {
+        Condensation condensation(sedi, threads);
+        auto step = [&] {
+            state.freeze();
+            condensation.condense(state, sps, fluctuations, 0.1);
+        };
+        step();
+        auto before = allocation_count();
+        for (int i = 0; i < 20; ++i) {
+            step();
+        }
+        EXPECT_EQ(allocation_count() - before, 0u) << threads << " threads";
+    }
+
+    // the counter sees the aligned superparticle columns grow
+    auto before = allocation_count();
+    for (int i = 0; i < 2000; ++i) {
+        sps.push_back({1.e-5, 10., 1.e-8, 10000000});
+    }
+    EXPECT_GT(allocation_count() - before, 0u);
+
+    // the deep copy the frozen layers replace allocates on every step
+    before = allocation_count();
+    State old_state(state);
+    EXPECT_GT(allocation_count() - before, 0u);
+}
@@ -0,0 +1,150 @@
+#include <cstdint>
+#include <vector>
+#include "analize_sp.h"
+#include "collision.h"
+#include "grid.h"
+#include "gtest/gtest.h"
+#include "sedimentation.h"
+#include "superparticle.h"
+#include "superparticle_store.h"
+
+TEST(aligned_column, test_alignment) {
+    AlignedColumn<double> c;
+    for (int i = 0; i < 100; ++i) {
+        c.push_back(i);
+    }
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(c.data()) % 64, 0u);
+    EXPECT_EQ(c.size(), 100u);
+    EXPECT_EQ(c[99], 99.);
+}
+
+TEST(superparticle_store, test_push_back_and_ref) {
+    SuperparticleStore sps;
+    sps.push_back({0.00001, 1.5, 1.e-6, int(1e8)});
+    ASSERT_EQ(sps.size(), 1u);
+    EXPECT_EQ(sps.z[0], 1.5);
+    EXPECT_EQ(sps[0].N, int(1e8));
+    EXPECT_DOUBLE_EQ(sps[0].radius(), radius(1.e-5, 1e8, 1.e-6, 1.));
+    sps[0].qc = 0.00002;
+    sps[0].update();
+    EXPECT_DOUBLE_EQ(sps.radius[0], radius(2.e-5, 1e8, 1.e-6, 1.));
+    Superparticle sp = sps[0];
+    EXPECT_EQ(sp.qc, 0.00002);
+    EXPECT_DOUBLE_EQ(sp.radius(), sps.radius[0]);
+}
+
+TEST(superparticle_store, test_remove_unnucleated) {
+    SuperparticleStore sps;
+    sps.push_back({0.00001, 1, 1.e-6, int(1e8)});
+    sps.push_back({0.00001, 2, 1.e-6, int(1e8)});
+    sps.push_back({0.00001, 3, 1.e-6, int(1e8)});
+    sps.is_nucleated[1] = false;
+    sps.remove_unnucleated();
+    ASSERT_EQ(sps.size(), 2u);
+    EXPECT_EQ(sps.z[0], 1.);
+    EXPECT_EQ(sps.z[1], 3.);
+}
+
+TEST(superparticle_store, test_sort_by_z) {
+    SuperparticleStore sps;
+    sps.push_back({0.00003, 3, 1.e-6, 3});
+    sps.push_back({0.00001, 1, 1.e-6, 1});
+    sps.push_back({0.00002, 2, 1.e-6, 2});
+    sort_by_z(sps);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(sps.z[i], i + 1.);
+        EXPECT_EQ(sps.N[i], i + 1);
+        EXPECT_DOUBLE_EQ(sps.radius[i], radius(sps.qc[i], i + 1, 1.e-6, 1.));
+    }
+}
+
+TEST(superparticle_store, test_profiles_match_vector) {
+    std::vector<Superparticle> v{{0.00001, 1, 1.e-6, int(1e8)},
+                                 {0.00002, 1.4, 1.e-6, int(1e8)},
+                                 {0.00003, 2, 1.e-6, int(1e8)}};
+    SuperparticleStore sps;
+    for (const auto& s : v) {
+        sps.push_back(s);
+    }
+    Grid grid{3., 1.};
+    EXPECT_EQ(count_nucleated(sps, grid), count_nucleated(v, grid));
+    EXPECT_EQ(calculate_qc_profile(sps, grid), calculate_qc_profile(v, grid));
+    EXPECT_EQ(calculate_mean_radius_profile(sps, grid),
+              calculate_mean_radius_profile(v, grid));
+}
+
+TEST(superparticle_store, test_collide_matches_vector) {
+    std::vector<Superparticle> v{{0.001, 0, 0, 100000000},
+                                 {0.003, 0, 0, 100000002}};
+    SuperparticleStore sps;
+    for (const auto& s : v) {
+        sps.push_back(s);
+    }
+    FallSpeedLU sedi;
+    BoxCollisions<HallCollisionKernal<Efficiencies>> bc(sedi, {{}});
+    std::vector<SpMassTendencies> mt_v(v.size());
+    std::vector<SpMassTendencies> mt_s(sps.size());
+    bc.collide(v.begin(), v.end(), mt_v.begin(), 0.1);
+    bc.collide(sps.begin(), sps.end(), mt_s.begin(), 0.1);
+    for (size_t i = 0; i < v.size(); ++i) {
+        EXPECT_EQ(mt_v[i].dN, mt_s[i].dN);
+        EXPECT_EQ(mt_v[i].dqc, mt_s[i].dqc);
+    }
+}
+
+TEST(superparticle_store, test_insert_reuses_dead_slots) {
+    SuperparticleStore sps;
+    for (int i = 0; i < 4; ++i) {
+        sps.push_back({0.00001, i + 0.5, 1.e-6, int(1e8)});
+    }
+    sps.is_nucleated[1] = false;
+    sps.is_nucleated[3] = false;
+    EXPECT_EQ(sps.collect_dead(), 2u);
+    EXPECT_EQ(sps.n_live(), 2u);
+    auto generation = sps.generation();
+
+    auto it = slot_inserter(sps);
+    *it++ = Superparticle{0.00002, 10.5, 1.e-6, int(1e8)};
+    *it++ = Superparticle{0.00002, 11.5, 1.e-6, int(1e8)};
+    *it++ = Superparticle{0.00002, 12.5, 1.e-6, int(1e8)};
+    ASSERT_EQ(sps.size(), 5u);
+    EXPECT_EQ(sps.z[1], 10.5);
+    EXPECT_EQ(sps.z[3], 11.5);
+    EXPECT_EQ(sps.z[4], 12.5);
+    EXPECT_TRUE(sps.is_nucleated[1]);
+    EXPECT_EQ(sps.n_dead(), 0u);
+    EXPECT_EQ(sps.generation(), generation);
+}
+
+TEST(superparticle_store, test_compaction_drops_filed_slots) {
+    SuperparticleStore sps;
+    for (int i = 0; i < 4; ++i) {
+        sps.push_back({0.00001, i + 0.5, 1.e-6, int(1e8)});
+    }
+    sps.is_nucleated[0] = false;
+    sps.collect_dead();
+    sps.remove_unnucleated();
+    EXPECT_EQ(sps.n_dead(), 0u);
+    sps.insert({0.00002, 10.5, 1.e-6, int(1e8)});
+    ASSERT_EQ(sps.size(), 4u);
+    EXPECT_EQ(sps.z[3], 10.5);
+}
+
+TEST(superparticle_store, test_ids_are_unique_and_move_with_particles) {
+    SuperparticleStore sps;
+    for (int i = 0; i < 4; ++i) {
+        sps.push_back({0.00001, i + 0.5, 1.e-6, int(1e8)});
+    }
+    EXPECT_EQ(sps.id[0], 0u);
+    EXPECT_EQ(sps.id[3], 3u);
+    sps.is_nucleated[1] = false;
+    sps.collect_dead();
+    sps.insert({0.00002, 10.5, 1.e-6, int(1e8)});
+    EXPECT_EQ(sps.id[1], 4u);
+    sps.is_nucleated[0] = false;
+    sps.remove_unnucleated();
+    ASSERT_EQ(sps.size(), 3u);
+    EXPECT_EQ(sps.id[0], 4u);
+    EXPECT_EQ(sps.id[1], 2u);
+    EXPECT_EQ(Superparticle(sps[2]).id, 3u);
+}
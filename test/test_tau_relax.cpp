@@ -1,15 +1,18 @@
 #include "gtest/gtest.h"
 #include "tau_relax.h"
+#include "cell_index.h"
 #include "grid.h"
-#include "superparticle.h"
+#include "superparticle_store.h"
 
 TEST(tau_relax, test_refresh){
     Grid  grid{300., 100.};
     TauRelax relax(grid);
 
-    std::vector<Superparticle> sp;
+    SuperparticleStore sp;
     sp.push_back({0.00001, 50, 1.e-6, 100000000, true});
 
-    relax.refresh(sp);
+    CellIndex cells(grid);
+    cells.update(sp);
+    relax.refresh(sp, cells);
     EXPECT_TRUE(true);
 }
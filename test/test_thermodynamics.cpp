@@ -419,3 +419,60 @@ TEST(sixth_order_wickerskamarock, test_updraft_ground){
     EXPECT_EQ(q[4], 0);
     EXPECT_EQ(q[5], 0);
 }
+
+TEST(implicit_condensation_solver, is_exact_without_radiation) {
+    double r = 1.e-7;
+    double a = diffusional_growth(r, 1500, 273.15, 0.01, 0, 0.1) * r;
+    for (double dt : {0.01, 1., 100.}) {
+        double expected = std::sqrt(r * r + 2. * a * dt);
+        EXPECT_NEAR(implicit_condensation_solver(r, 1500, 273.15, 0.01, 0, dt),
+                    expected, 1.e-12 * expected);
+    }
+}
+
+TEST(implicit_condensation_solver, matches_euler_for_small_steps) {
+    double r = 1.e-5;
+    double dt = 1.e-3;
+    double euler = condensation_solver(r, 1500, 273.15, 0.01, 100., dt);
+    double implicit =
+        implicit_condensation_solver(r, 1500, 273.15, 0.01, 100., dt);
+    EXPECT_NEAR(implicit, euler, 1.e-4 * (euler - r));
+}
+
+TEST(implicit_condensation_solver, stays_bounded_for_large_steps) {
+    // euler overshoots by orders of magnitude for a fresh droplet
+    double r = 1.e-8;
+    double dt = 1.;
+    double euler = condensation_solver(r, 1500, 273.15, 0.01, 0, dt);
+    double implicit = implicit_condensation_solver(r, 1500, 273.15, 0.01, 0,
+                                                   dt);
+    double substeps = r;
+    for (int i = 0; i < 1000; ++i) {
+        substeps = condensation_solver(substeps, 1500, 273.15, 0.01, 0,
+                                       dt / 1000);
+    }
+    EXPECT_GT(euler, 10. * substeps);
+    EXPECT_NEAR(implicit, substeps, 0.01 * substeps);
+    EXPECT_EQ(implicit_condensation_solver(r, 1500, 273.15, -0.5, 0, dt), 0.);
+}
+
+TEST(condensation, implicit_growth_evaporates_to_the_dry_radius) {
+    double N = 1.e8;
+    double r_dry = 1.e-8;
+    double qc = cloud_water(N, 2.e-8, r_dry);
+    auto tendencies =
+        condensation(qc, N, r_dry, -0.5, 273.15, 0, 10., GrowthScheme::implicit);
+    EXPECT_EQ(tendencies.dqc, -qc);
+}
+
+TEST(condensation_solver, euler_step_rounds_as_before) {
+    // default runs stay bit for bit with the growth of the baseline model
+    double es = 1500., T = 273.15, S = 0.01, E = 100.;
+    double c1 = H_LAT * H_LAT / (R_V * K * T * T) + R_V * T / (D * es);
+    double c2 = H_LAT / (R_V * K * T * T);
+    for (double r = 1.e-7; r < 1.e-4; r *= 1.1) {
+        double growth = (S / r + c2 * E) / (c1 * RHO_H2O);
+        EXPECT_EQ(diffusional_growth(r, es, T, S, E, 0.1), growth);
+        EXPECT_EQ(condensation_solver(r, es, T, S, E, 0.1), r + 0.1 * growth);
+    }
+}
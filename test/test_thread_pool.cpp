@@ -0,0 +1,37 @@
+#include <stdexcept>
+#include <vector>
+#include "gtest/gtest.h"
+#include "thread_pool.h"
+
+TEST(thread_pool, runs_every_task_once) {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4u);
+    for (int round = 0; round < 100; ++round) {
+        std::vector<int> count(37, 0);
+        pool.run(count.size(), [&](size_t i) { ++count[i]; });
+        for (auto c : count) {
+            EXPECT_EQ(c, 1);
+        }
+    }
+}
+
+TEST(thread_pool, single_thread_runs_inline) {
+    ThreadPool pool(1);
+    std::vector<size_t> order;
+    pool.run(5, [&](size_t i) { order.push_back(i); });
+    EXPECT_EQ(order, (std::vector<size_t>{0, 1, 2, 3, 4}));
+}
+
+TEST(thread_pool, rethrows_task_exceptions) {
+    ThreadPool pool(3);
+    EXPECT_THROW(pool.run(10,
+                          [](size_t i) {
+                              if (i == 7) {
+                                  throw std::logic_error("task failed");
+                              }
+                          }),
+                 std::logic_error);
+    int sum = 0;
+    pool.run(1, [&](size_t i) { sum += 1; });
+    EXPECT_EQ(sum, 1);
+}
@@ -0,0 +1,83 @@
+#include <stdexcept>
+#include "cell_index.h"
+#include "grid.h"
+#include "gtest/gtest.h"
+#include "state.h"
+#include "superparticle_store.h"
+#include "validation.h"
+
+static State make_state(const Grid& grid) {
+    State state{0, {}, {}, grid, 500., 1.};
+    for (unsigned int i = 0; i < grid.n_lay; ++i) {
+        state.layers.push_back({280., 90000., 0.01, 0.});
+    }
+    for (unsigned int i = 0; i < grid.n_lvl; ++i) {
+        state.levels.push_back({1., 90000.});
+    }
+    return state;
+}
+
+static SuperparticleStore make_superparticles() {
+    SuperparticleStore sps;
+    sps.push_back({0.00001, 0.5, 1.e-6, int(1e8)});
+    sps.push_back({0.00001, 1.5, 1.e-6, int(1e8)});
+    sps.push_back({0.00001, 2.5, 1.e-6, int(1e8)});
+    return sps;
+}
+
+typedef StepValidator<Validation::off> Off;
+typedef StepValidator<Validation::cheap> Cheap;
+typedef StepValidator<Validation::audit, 2> Audit;
+
+TEST(validation, off_checks_nothing) {
+    Grid grid{3., 1.};
+    State state = make_state(grid);
+    state.layers[1].qv = -1.;
+    auto sps = make_superparticles();
+    sps.qc[0] = -1.;
+    CellIndex cells(grid);
+    EXPECT_NO_THROW(Off::particle(sps[0]));
+    EXPECT_NO_THROW(Off::before_condensation(0, state, sps));
+    EXPECT_NO_THROW(Off::after_step(0, state, sps, cells));
+}
+
+TEST(validation, cheap_checks_particles_and_state) {
+    Grid grid{3., 1.};
+    State state = make_state(grid);
+    auto sps = make_superparticles();
+    sps.qc[0] = -1.;
+    CellIndex cells(grid);
+    EXPECT_THROW(Cheap::particle(sps[0]), std::logic_error);
+    // no full audit: the stale cell index is not noticed
+    EXPECT_NO_THROW(Cheap::before_condensation(0, state, sps));
+    EXPECT_NO_THROW(Cheap::after_step(0, state, sps, cells));
+    state.layers[1].qv = -1.;
+    EXPECT_THROW(Cheap::before_condensation(0, state, sps), std::logic_error);
+}
+
+TEST(validation, audit_runs_on_every_interval) {
+    Grid grid{3., 1.};
+    State state = make_state(grid);
+    auto sps = make_superparticles();
+    CellIndex cells(grid);
+    cells.update(sps);
+    EXPECT_NO_THROW(Audit::after_step(0, state, sps, cells));
+    sps.z[0] = 1.5;
+    EXPECT_NO_THROW(Audit::after_step(1, state, sps, cells));
+    EXPECT_THROW(Audit::after_step(2, state, sps, cells), std::logic_error);
+    cells.update(sps);
+    EXPECT_NO_THROW(Audit::after_step(2, state, sps, cells));
+}
+
+TEST(validation, audit_finds_stale_radius) {
+    Grid grid{3., 1.};
+    State state = make_state(grid);
+    auto sps = make_superparticles();
+    sps.qc[1] = 0.00002;
+    EXPECT_THROW(Audit::before_condensation(0, state, sps), std::logic_error);
+    sps.update(1);
+    EXPECT_NO_THROW(Audit::before_condensation(0, state, sps));
+    sps.is_nucleated[2] = false;
+    sps.qc[2] = 0.00003;
+    EXPECT_NO_THROW(Audit::before_condensation(0, state, sps));
+}
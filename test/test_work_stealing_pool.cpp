@@ -0,0 +1,85 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "work_stealing_pool.h"
+
+TEST(work_stealing_pool, runs_every_task_once) {
+    WorkStealingPool pool(4);
+    EXPECT_EQ(pool.size(), 4u);
+    std::vector<std::atomic<int>> count(101);
+    for (auto& c : count) {
+        c = 0;
+    }
+    for (size_t i = 0; i < count.size(); ++i) {
+        pool.submit([&count, i] { ++count[i]; });
+    }
+    pool.wait();
+    for (const auto& c : count) {
+        EXPECT_EQ(c.load(), 1);
+    }
+}
+
+TEST(work_stealing_pool, tasks_can_submit_tasks) {
+    WorkStealingPool pool(3);
+    std::atomic<int> count{0};
+    for (int i = 0; i < 10; ++i) {
+        pool.submit([&] {
+            for (int k = 0; k < 10; ++k) {
+                pool.submit([&] { ++count; });
+            }
+        });
+    }
+    pool.wait();
+    EXPECT_EQ(count.load(), 100);
+}
+
+TEST(work_stealing_pool, can_be_reused_after_wait) {
+    WorkStealingPool pool(2);
+    std::atomic<int> count{0};
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 5; ++i) {
+            pool.submit([&] { ++count; });
+        }
+        pool.wait();
+        EXPECT_EQ(count.load(), 5 * (round + 1));
+    }
+}
+
+TEST(work_stealing_pool, rethrows_task_exceptions) {
+    WorkStealingPool pool(3);
+    std::atomic<int> count{0};
+    for (int i = 0; i < 10; ++i) {
+        pool.submit([&, i] {
+            if (i == 7) {
+                throw std::logic_error("task failed");
+            }
+            ++count;
+        });
+    }
+    EXPECT_THROW(pool.wait(), std::logic_error);
+    EXPECT_EQ(count.load(), 9);
+    pool.submit([&] { ++count; });
+    EXPECT_NO_THROW(pool.wait());
+}
+
+TEST(work_stealing_pool, waits_for_a_task_whose_child_finished_first) {
+    WorkStealingPool pool(2);
+    for (int round = 0; round < 200; ++round) {
+        std::atomic<bool> child{false};
+        std::atomic<bool> parent{false};
+        pool.submit([&] {
+            pool.submit([&] { child = true; });
+            // the child is stolen by the other worker
+            while (!child) {
+                std::this_thread::yield();
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            parent = true;
+        });
+        pool.wait();
+        EXPECT_TRUE(parent.load());
+    }
+}